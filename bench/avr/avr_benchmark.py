@@ -0,0 +1,80 @@
+#!/usr/bin/env python3
+"""
+Runs the BitLoom AVR benchmarks in simavr and reports footprint and cycles.
+
+The footprint is read with avr-size from the object files of the core modules
+(flash = text + data, static RAM = data + bss).  The cycles are printed by the
+benchmark programs (bench.c) on the simavr console.
+
+Usage:
+    avr_benchmark.py --simavr <simavr> --size <avr-size>
+                     --bench <tasks>:<elf>:<object>[,<object>...] ...
+
+Copyright (c) 2021 BlueZephyr
+
+This software may be modified and distributed under the terms
+of the MIT license.  See the LICENSE file for details.
+"""
+
+import argparse
+import os
+import re
+import subprocess
+import sys
+
+RESULT = re.compile(r"bench tasks=(\d+) scenario=(\S+) min=(\d+) max=(\d+) avg=(\d+)")
+
+
+def footprint(size_tool, objects):
+    output = subprocess.run([size_tool] + objects, check=True,
+                            stdout=subprocess.PIPE, universal_newlines=True).stdout
+    sizes = {}
+    for line in output.splitlines()[1:]:
+        fields = line.split()
+        text, data, bss = int(fields[0]), int(fields[1]), int(fields[2])
+        name = os.path.basename(fields[-1]).split(".")[0]
+        sizes[name] = (text + data, data + bss)
+    return sizes
+
+
+def run(simavr, elf):
+    output = subprocess.run([simavr, elf], stdout=subprocess.PIPE,
+                            stderr=subprocess.STDOUT, universal_newlines=True,
+                            timeout=300).stdout
+    results = {}
+    for line in output.splitlines():
+        match = RESULT.search(line)
+        if match:
+            results[match.group(2)] = tuple(int(v) for v in match.group(3, 4, 5))
+    if not results:
+        sys.exit("No results from %s:\n%s" % (elf, output))
+    return results
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__.split("\n\n")[0])
+    parser.add_argument("--simavr", required=True)
+    parser.add_argument("--size", required=True)
+    parser.add_argument("--bench", action="append", required=True)
+    args = parser.parse_args()
+
+    print("%-6s %-10s %8s %8s" % ("tasks", "module", "flash", "ram"))
+    runs = []
+    for bench in args.bench:
+        tasks, elf, objects = bench.split(":")
+        for module, (flash, ram) in sorted(footprint(args.size, objects.split(",")).items()):
+            print("%-6s %-10s %8d %8d" % (tasks, module, flash, ram))
+        runs.append((int(tasks), run(args.simavr, elf)))
+
+    print()
+    print("%-6s %-18s %8s %8s %8s" % ("tasks", "scenario", "min", "max", "avg"))
+    for tasks, results in runs:
+        for scenario, (minimum, maximum, average) in results.items():
+            print("%-6d %-18s %8d %8d %8d" % (tasks, scenario, minimum, maximum, average))
+        if "idle" in results and "all" in results:
+            print("%-6d %-18s %26d" % (tasks, "per dispatch",
+                                       (results["all"][2] - results["idle"][2]) // tasks))
+
+
+if __name__ == "__main__":
+    main()
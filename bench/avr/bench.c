@@ -0,0 +1,289 @@
+/*
+ * Cycle benchmark of the BitLoom core on AVR.
+ *
+ * The benchmark is run in the simavr instruction-set simulator.  The cycles
+ * are measured with Timer1 running at the CPU clock and the results are
+ * printed on the simavr console.  When done, the program sleeps with the
+ * interrupts disabled, which makes simavr exit.
+ *
+ * Each result is printed on one line:
+ *   bench tasks=<n> scenario=<name> min=<cycles> max=<cycles> avg=<cycles>
+ *
+ * Copyright (c) 2021. BlueZephyr
+ *
+ * This software may be modified and distributed under the terms
+ * of the MIT license.  See the LICENSE file for details.
+ *
+ */
+
+#include <avr/io.h>
+#include <avr/interrupt.h>
+#include <avr/sleep.h>
+#include <stdio.h>
+#include "avr_mcu_section.h"
+#include "core/scheduler.h"
+#include "hal/timer.h"
+#ifdef BENCH_UART_DRIVER
+#include "core/uart.h"
+#include "hal/uart_hal.h"
+#endif
+
+AVR_MCU(F_CPU, BENCH_MCU);
+AVR_MCU_SIMAVR_CONSOLE(&GPIOR0);
+
+#define BENCH_NO_OF_TICKS   1000
+
+volatile Tick_t bench_ticks;
+
+typedef struct
+{
+    uint16_t min;
+    uint16_t max;
+    uint32_t sum;
+    uint16_t count;
+} Result_t;
+
+static uint16_t overhead;
+
+static int console_putchar (char c, FILE *stream)
+{
+    (void)stream;
+    GPIOR0 = c;
+    return 0;
+}
+static FILE console = FDEV_SETUP_STREAM(console_putchar, NULL, _FDEV_SETUP_WRITE);
+
+/*
+ * Timer HAL.  The benchmark controls the ticks directly.
+ */
+void timer_init (void)
+{
+}
+
+void timer_start (void)
+{
+}
+
+void timer_stop (void)
+{
+}
+
+#ifdef BENCH_UART_DRIVER
+/*
+ * UART HAL.  No hardware is used, the out buffer is drained by the benchmark.
+ */
+static bytebuffer_t *out_buffer;
+
+void uart_hal_init (enum uart_port_t port, bytebuffer_t *outBuffer)
+{
+    (void)port;
+    out_buffer = outBuffer;
+}
+
+void uart_hal_send (enum uart_port_t port)
+{
+    (void)port;
+}
+
+void uart_hal_send_immediate (enum uart_port_t port, uint8_t byte)
+{
+    (void)port;
+    (void)byte;
+}
+#endif
+
+static void empty_task (void)
+{
+}
+
+static void result_init (Result_t *result)
+{
+    result->min = UINT16_MAX;
+    result->max = 0;
+    result->sum = 0;
+    result->count = 0;
+}
+
+static void result_add (Result_t *result, uint16_t cycles)
+{
+    if (cycles < result->min)
+    {
+        result->min = cycles;
+    }
+    if (cycles > result->max)
+    {
+        result->max = cycles;
+    }
+    result->sum += cycles;
+    result->count++;
+}
+
+static void result_print (const char *scenario, const Result_t *result)
+{
+    printf("bench tasks=%u scenario=%s min=%u max=%u avg=%lu\n",
+           (unsigned)SCHEDULER_NO_TASKS, scenario, result->min, result->max,
+           result->sum / result->count);
+}
+
+static uint16_t measure_tick (void)
+{
+    uint16_t start;
+    uint16_t end;
+
+    bench_ticks++;
+    start = TCNT1;
+    schedule_run();
+    end = TCNT1;
+    return end - start - overhead;
+}
+
+static void run_ticks (const char *scenario, uint16_t no_of_ticks)
+{
+    Result_t result;
+    uint16_t tick;
+
+    result_init(&result);
+    schedule_start();
+    for (tick=0; tick<no_of_ticks; tick++)
+    {
+        result_add(&result, measure_tick());
+    }
+    result_print(scenario, &result);
+}
+
+/*
+ * No task is due in any tick, i.e., the cost of the tick itself.  The tasks
+ * are first due in tick 255.
+ */
+static void bench_idle (void)
+{
+    uint8_t task;
+
+    bench_ticks = 0;
+    schedule_init();
+    for (task=0; task<SCHEDULER_NO_TASKS; task++)
+    {
+        schedule_add_task(255, 0, empty_task);
+    }
+    run_ticks("idle", 250);
+}
+
+/*
+ * All tasks are due in every tick.  The difference from the idle scenario
+ * divided by the number of tasks is the cost per dispatch.
+ */
+static void bench_all (void)
+{
+    uint8_t task;
+
+    bench_ticks = 0;
+    schedule_init();
+    for (task=0; task<SCHEDULER_NO_TASKS; task++)
+    {
+        schedule_add_task(1, 0, empty_task);
+    }
+    run_ticks("all", BENCH_NO_OF_TICKS);
+}
+
+/*
+ * Tasks with different periods and automatically selected offsets.
+ */
+static void bench_mixed (void)
+{
+    uint8_t task;
+
+    bench_ticks = 0;
+    schedule_init();
+    for (task=0; task<SCHEDULER_NO_TASKS; task++)
+    {
+        schedule_add_task((task % 8) + 2, SCHEDULE_OFFSET_AUTO, empty_task);
+    }
+    run_ticks("mixed", BENCH_NO_OF_TICKS);
+}
+
+#ifdef BENCH_UART_DRIVER
+static void bench_uart (void)
+{
+    uint8_t data[16] = {0};
+    Result_t write;
+    Result_t receive;
+    Result_t receive_port;
+    Result_t read;
+    uint16_t start;
+    uint16_t end;
+    uint8_t i;
+    uint8_t j;
+
+    result_init(&write);
+    result_init(&receive);
+    result_init(&receive_port);
+    result_init(&read);
+    uart_init(BENCH_UART);
+
+    for (i=0; i<100; i++)
+    {
+        start = TCNT1;
+        uart_write(BENCH_UART, data, sizeof(data));
+        end = TCNT1;
+        result_add(&write, end - start - overhead);
+        while (!bytebuffer_isEmpty(out_buffer))
+        {
+            bytebuffer_read(out_buffer);
+        }
+
+        for (j=0; j<sizeof(data); j++)
+        {
+            start = TCNT1;
+            uart_receive_byte(BENCH_UART, j);
+            end = TCNT1;
+            result_add(&receive, end - start - overhead);
+        }
+        uart_read(BENCH_UART, data, sizeof(data));
+
+        for (j=0; j<sizeof(data); j++)
+        {
+            start = TCNT1;
+            UART_RECEIVE_BYTE(BENCH_UART, j);
+            end = TCNT1;
+            result_add(&receive_port, end - start - overhead);
+        }
+
+        start = TCNT1;
+        uart_read(BENCH_UART, data, sizeof(data));
+        end = TCNT1;
+        result_add(&read, end - start - overhead);
+    }
+
+    result_print("uart_write_16", &write);
+    result_print("uart_receive_byte", &receive);
+    result_print("UART_RECEIVE_BYTE", &receive_port);
+    result_print("uart_read_16", &read);
+}
+#endif
+
+int main (void)
+{
+    uint16_t start;
+    uint16_t end;
+
+    stdout = &console;
+
+    // Timer1 counts CPU cycles
+    TCCR1A = 0;
+    TCCR1B = (1 << CS10);
+    start = TCNT1;
+    end = TCNT1;
+    overhead = end - start;
+
+    bench_idle();
+    bench_all();
+    bench_mixed();
+#ifdef BENCH_UART_DRIVER
+    bench_uart();
+#endif
+
+    sleep_enable();
+    cli();
+    sleep_cpu();
+    return 0;
+}
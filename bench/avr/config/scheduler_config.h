@@ -0,0 +1,9 @@
+#ifndef SCHEDULER_CONFIG_H
+#define SCHEDULER_CONFIG_H
+
+/*
+ * The number of tasks is given by the benchmark build for each task count.
+ */
+#define SCHEDULER_NO_TASKS      BENCH_NO_TASKS
+
+#endif  // SCHEDULER_CONFIG_H
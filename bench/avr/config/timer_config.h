@@ -0,0 +1,14 @@
+#ifndef TIMER_CONFIG_H
+#define TIMER_CONFIG_H
+
+/*
+ * The benchmark advances the ticks itself before each call to schedule_run.
+ * The ticks are read from a global variable as recommended for targets.
+ */
+
+#include <stdint.h>
+#define Tick_t uint8_t
+extern volatile Tick_t bench_ticks;
+#define TIMER_GET_TICKS() bench_ticks
+
+#endif  // TIMER_CONFIG_H
@@ -0,0 +1,18 @@
+#ifndef UART_CONFIG_H
+#define UART_CONFIG_H
+
+#include <avr/io.h>
+#include <avr/interrupt.h>
+
+/*
+ * One port with the buffer sizes typically used on the AVR targets.
+ */
+#define UART_PORTS(X) \
+    X(BENCH_UART, 64, 64, UART_FLOW_CONTROL_NONE, 0, 0)
+
+#define UART_FLOW_CONTROL       UART_FLOW_CONTROL_NONE
+
+#define UART_CRITICAL_ENTER()   uint8_t uart_sreg = SREG; cli()
+#define UART_CRITICAL_EXIT()    SREG = uart_sreg
+
+#endif  // UART_CONFIG_H
@@ -0,0 +1,122 @@
+/*
+ * Host executor for BitLoom.
+ *
+ * The executor runs a number of scheduler instances (see scheduler instances
+ * in scheduler.h) on a pool of threads, e.g., to simulate a fleet of nodes in
+ * one process.  The instances share a virtual clock.  In each tick of the
+ * clock, every instance is ticked exactly once and the next tick is not
+ * started until all instances have completed the current tick.  The executor
+ * does not use the timer, i.e., the simulation runs as fast as the tasks allow.
+ *
+ * At the start of each tick, the instances are divided in equal ranges, one
+ * per thread.  A thread ticks the instances of its own range in batches of
+ * EXECUTOR_BATCH_SIZE instances.  When its range is empty, it steals half of
+ * the remaining instances of another thread's range.  Slow instances hence do
+ * not leave the other threads idle.
+ *
+ * The instances may run in parallel, i.e., tasks of different instances must
+ * not share data without synchronisation.  Data that is only exchanged between
+ * ticks, e.g., written by one instance and read by another in a later tick,
+ * needs no further synchronisation.
+ *
+ * The executor is only available on hosts with POSIX threads.  It requires an
+ * executor_config.h file with the following defines:
+ *  * EXECUTOR_MAX_THREADS - Maximum number of threads of an executor
+ *  * EXECUTOR_BATCH_SIZE - Number of instances taken from a range at a time
+ *
+ * Copyright (c) 2021 BlueZephyr
+ *
+ * This software may be modified and distributed under the terms
+ * of the MIT license.  See the LICENSE file for details.
+ *
+ */
+
+#ifndef BL_EXECUTOR_H
+#define BL_EXECUTOR_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <pthread.h>
+#include "core/scheduler.h"
+#include "config/executor_config.h"
+
+/*
+ * The state of an executor.  The memory is provided by the user.  The members
+ * must not be accessed directly.
+ */
+typedef struct executor_range_t
+{
+    pthread_mutex_t lock;
+    uint32_t next;      // The first instance that has not been taken
+    uint32_t end;       // One past the last instance
+} executor_range_t;
+
+typedef struct executor_worker_t
+{
+    struct executor_t *executor;
+    pthread_t thread;
+    executor_range_t range;
+    uint8_t id;
+    uint32_t steals;
+} executor_worker_t;
+
+typedef struct executor_t
+{
+    Scheduler_t * const *instances;
+    uint32_t no_of_instances;
+    uint8_t no_of_threads;
+    executor_worker_t workers[EXECUTOR_MAX_THREADS];
+    pthread_mutex_t lock;
+    pthread_cond_t tick_start;
+    pthread_cond_t tick_done;
+    uint8_t pending;    // Threads that have not completed the current tick
+    uint32_t ticks;     // The virtual clock
+    bool stop;
+} executor_t;
+
+/*
+ * Init the executor and start its threads.  The instances must have been
+ * initiated (scheduler_init) and must stay allocated until the executor has
+ * been destroyed.  The calling thread is used as one of the threads, i.e.,
+ * no_of_threads - 1 threads are created.  Returns false if no_of_threads is 0
+ * or larger than EXECUTOR_MAX_THREADS or if the threads cannot be created.
+ */
+bool executor_init (executor_t *executor, Scheduler_t * const *instances,
+                    uint32_t no_of_instances, uint8_t no_of_threads);
+
+/*
+ * Advance the virtual clock the specified number of ticks.  The function
+ * returns when all instances have completed the last tick.
+ */
+void executor_run (executor_t *executor, uint32_t ticks);
+
+/*
+ * Returns the number of ticks of the virtual clock since init.
+ */
+uint32_t executor_get_ticks (const executor_t *executor);
+
+/*
+ * Returns the number of times a thread has stolen instances from another
+ * thread since init.
+ */
+uint32_t executor_get_steals (const executor_t *executor);
+
+/*
+ * Stop the threads of the executor and release its resources.
+ */
+void executor_destroy (executor_t *executor);
+
+/*
+ * Returns the instance that is being ticked by the calling thread, i.e., a
+ * task's run function can get the instance that it belongs to.  Returns NULL
+ * if the calling thread is not ticking an instance.
+ */
+Scheduler_t *executor_current_instance (void);
+
+/*
+ * Returns the tick of the virtual clock that is being run by the calling
+ * thread.  The first tick is 1.
+ */
+uint32_t executor_current_tick (void);
+
+#endif // BL_EXECUTOR_H
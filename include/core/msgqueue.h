@@ -0,0 +1,100 @@
+/*
+ * Message queues for BitLoom.
+ *
+ * A message queue passes fixed-size blocks from one producer to one consumer,
+ * typically from an interrupt service routine to a task.  The blocks are taken
+ * from a pool that belongs to the queue.  The producer allocates a block,
+ * fills it and posts it.  The consumer receives the block, processes it and
+ * releases it back to the pool.  Only pointers are passed, i.e., the data is
+ * never copied.
+ *
+ * The queue is lock-free as long as there is only one producer and one
+ * consumer.  The producer may only call msgqueue_alloc and msgqueue_post, and
+ * the consumer may only call msgqueue_receive and msgqueue_release.  The
+ * producer and the consumer may run in different contexts (e.g., interrupt
+ * and task).
+ *
+ * Optionally, an event-triggered task (see scheduler.h) can be woken each
+ * time a message is posted.  The task shall receive all messages in the queue
+ * each time it runs.
+ *
+ * Copyright (c) 2021 BlueZephyr
+ *
+ * This software may be modified and distributed under the terms
+ * of the MIT license.  See the LICENSE file for details.
+ *
+ */
+
+#ifndef BL_MSGQUEUE_H
+#define BL_MSGQUEUE_H
+
+#include <stdint.h>
+
+/*
+ * The maximum number of blocks in a queue.
+ */
+#define MSGQUEUE_MAX_BLOCKS         254
+
+/*
+ * The number of pointers required for the rings of a queue with the specified
+ * number of blocks.
+ */
+#define MSGQUEUE_RINGS_SIZE(block_count)    (2 * ((block_count) + 1))
+
+/*
+ * The queue.  The members are internal to the message queue.
+ */
+typedef struct msgqueue_t
+{
+    void *volatile *free_ring;  // Released blocks (consumer -> producer)
+    void *volatile *msg_ring;   // Posted messages (producer -> consumer)
+    uint8_t ring_size;
+    volatile uint8_t free_head; // Written by the consumer
+    volatile uint8_t free_tail; // Written by the producer
+    volatile uint8_t msg_head;  // Written by the producer
+    volatile uint8_t msg_tail;  // Written by the consumer
+    uint8_t wake_task;
+} msgqueue_t;
+
+/*
+ * Init the queue.  This function must be called before any other function is
+ * called for the queue.  The caller provides the memory for the blocks and
+ * for the rings holding the free blocks and the posted messages.  The blocks
+ * memory must hold block_count blocks of block_size bytes each.  The rings
+ * must have MSGQUEUE_RINGS_SIZE(block_count) elements.  The block_count must
+ * be 1 - MSGQUEUE_MAX_BLOCKS.  The block_size should be a multiple of the
+ * alignment of the data stored in the blocks.
+ */
+void msgqueue_init (msgqueue_t *queue, void *blocks, uint16_t block_size,
+                    uint8_t block_count, void **rings);
+
+/*
+ * Set the event-triggered task to be triggered when a message is posted.  Use
+ * SCHEDULE_INVALID_TASK_ID (the default) to not trigger any task.
+ */
+void msgqueue_set_wake_task (msgqueue_t *queue, uint8_t taskid);
+
+/*
+ * Allocate a block from the queue's pool (producer).  Returns NULL if all
+ * blocks are in use.
+ */
+void *msgqueue_alloc (msgqueue_t *queue);
+
+/*
+ * Post an allocated block to the queue (producer).  The block must not be
+ * accessed by the producer after it has been posted.
+ */
+void msgqueue_post (msgqueue_t *queue, void *block);
+
+/*
+ * Receive the oldest message in the queue (consumer).  Returns NULL if the
+ * queue is empty.  The block must be released when it has been processed.
+ */
+void *msgqueue_receive (msgqueue_t *queue);
+
+/*
+ * Release a received block back to the queue's pool (consumer).
+ */
+void msgqueue_release (msgqueue_t *queue, void *block);
+
+#endif // BL_MSGQUEUE_H
@@ -0,0 +1,86 @@
+/*
+ * Memory pools for BitLoom.
+ *
+ * The pools provide deterministic allocation of fixed-size blocks without
+ * using the heap.  The pools and the size and number of blocks in each pool
+ * are configured at compile time.  Allocation and free are O(1) and may be
+ * used from both interrupt and task context.
+ *
+ * For each pool, the number of used blocks, the maximum number of used blocks
+ * (high-water mark) and the number of failed allocations are recorded.  The
+ * statistics can be used to size the pools from measured need.
+ *
+ * The pools require a pool_config.h file with the following defines:
+ *  * POOL_TABLE(X) - The list of pools, see the template
+ *  * POOL_CRITICAL_ENTER() and POOL_CRITICAL_EXIT() - Critical section
+ *
+ * Copyright (c) 2021 BlueZephyr
+ *
+ * This software may be modified and distributed under the terms
+ * of the MIT license.  See the LICENSE file for details.
+ *
+ */
+
+#ifndef BL_POOL_H
+#define BL_POOL_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "config/pool_config.h"
+
+/*
+ * The ids of the configured pools.  POOL_NO_POOLS is the number of pools.
+ */
+#define POOL_ID(id, block_size, no_of_blocks) id,
+enum pool_id_t
+{
+    POOL_TABLE(POOL_ID)
+    POOL_NO_POOLS
+};
+#undef POOL_ID
+
+/*
+ * Statistics for a pool.
+ */
+typedef struct
+{
+    uint16_t block_size;    // Size of each block in bytes (as configured)
+    uint16_t no_of_blocks;  // Number of blocks in the pool
+    uint16_t in_use;        // Number of currently allocated blocks
+    uint16_t high_water;    // Maximum number of allocated blocks
+    uint16_t failures;      // Number of failed allocations (saturating)
+} pool_stats_t;
+
+/*
+ * Init the pools.  This function must be called before any other function is
+ * used.  All blocks are returned to the pools and the statistics are cleared.
+ */
+void pool_init (void);
+
+/*
+ * Allocate a block from the specified pool.  Returns NULL if the pool is
+ * exhausted (or the pool id is invalid).  The block is aligned for any pointer
+ * or 32 bit data.
+ */
+void *pool_alloc (enum pool_id_t pool);
+
+/*
+ * Return a block to the pool it was allocated from.  Returns false, and the
+ * block is not returned, if the block is not a block of the pool or if no
+ * block of the pool is in use.  Other double frees are not detected.
+ */
+bool pool_free (enum pool_id_t pool, void *block);
+
+/*
+ * Get the statistics for the specified pool.  Returns false if the pool id is
+ * invalid.
+ */
+bool pool_get_stats (enum pool_id_t pool, pool_stats_t *stats);
+
+/*
+ * Reset the high-water mark to the current number of used blocks and clear
+ * the failure counter for the specified pool.
+ */
+void pool_reset_stats (enum pool_id_t pool);
+
+#endif // BL_POOL_H
@@ -10,6 +10,13 @@
  * The scheduler requires a config.h file with the following defines:
  *  * SCHEDULER_NO_TASKS - Number of tasks in the application (max 32)
  *
+ * Optionally, the scheduler measures the CPU load (see the load meter below).
+ *
+ * The schedule_ functions use the scheduler instance of the application.  On
+ * a host, several instances can be created and ticked explicitly with the
+ * scheduler_ functions (see scheduler instances below), e.g., to simulate a
+ * number of nodes in one process.
+ *
  * Copyright (c) 2016-2020 BlueZephyr
  *
  * This software may be modified and distributed under the terms
@@ -21,15 +28,96 @@
 #define BL_SCHEDULER_H
 
 #include <stdint.h>
+#include <stdbool.h>
 #include "config/scheduler_config.h"
 
 #define SCHEDULE_INVALID_TASK_ID    (uint8_t)0xFF
 
+/*
+ * Offset value that can be given to schedule_add_task to let the scheduler
+ * select the offset.  The scheduler will pick the offset within the task's
+ * period that collides with the least accumulated load of the tasks already
+ * added.  The load of a task is given by its cost (see schedule_set_task_cost).
+ */
+#define SCHEDULE_OFFSET_AUTO        (uint8_t)0xFF
+
+/*
+ * Default cost of a task.  Used when selecting offsets automatically.
+ */
+#define SCHEDULE_DEFAULT_TASK_COST  (uint8_t)1
+
+#ifdef SCHEDULER_LOAD_METER
+#ifndef SCHEDULER_LOAD_AVERAGE_SHIFT
+#define SCHEDULER_LOAD_AVERAGE_SHIFT    4
+#endif
+#ifndef SCHEDULER_LOAD_HISTOGRAM_BINS
+#define SCHEDULER_LOAD_HISTOGRAM_BINS   10
+#endif
+#endif
+
+#ifdef SCHEDULER_LOAD_SHEDDING
+#ifndef SCHEDULER_LOAD_METER
+#error "SCHEDULER_LOAD_SHEDDING requires SCHEDULER_LOAD_METER"
+#endif
+#ifndef SCHEDULER_SHED_LOAD_HIGH
+#define SCHEDULER_SHED_LOAD_HIGH        90
+#endif
+#ifndef SCHEDULER_SHED_LOAD_LOW
+#define SCHEDULER_SHED_LOAD_LOW         70
+#endif
+#ifndef SCHEDULER_SHED_FACTOR
+#define SCHEDULER_SHED_FACTOR           2
+#endif
+#endif
+
 /*
  * Prototype for the task run function that is called by the scheduler.
  */
 typedef void (*task_run)(void);
 
+/*
+ * The state of a scheduler instance (Scheduler_t) and its tasks.  The types are
+ * public so that instances can be allocated by the user.  The members must not
+ * be accessed directly.
+ */
+typedef struct Task_t
+{
+    uint8_t period;     // 0 for event-triggered tasks
+    uint16_t time;      // Ticks to the next release, up to period + offset
+    uint8_t cost;
+    uint8_t flags;
+#ifdef SCHEDULER_LOAD_SHEDDING
+    uint8_t base_period;    // The period when not shedding
+#endif
+    volatile uint8_t triggered;
+    uint16_t runs;
+    task_run run;   // The task's run function
+} Task_t;
+
+#ifdef SCHEDULER_LOAD_METER
+typedef struct LoadMeter_t
+{
+    uint8_t load;
+    uint8_t peak;
+    uint16_t average;   // Percent in 8.8 fixed point
+    uint16_t histogram[SCHEDULER_LOAD_HISTOGRAM_BINS];
+} LoadMeter_t;
+#endif
+
+typedef struct Scheduler_t
+{
+    Task_t tasks[SCHEDULER_NO_TASKS];
+    uint8_t no_of_tasks;
+    uint32_t task_error;
+    uint32_t tasks_run;     // The tasks that ran in the last tick
+#ifdef SCHEDULER_LOAD_METER
+    LoadMeter_t load_meter;
+#endif
+#ifdef SCHEDULER_LOAD_SHEDDING
+    bool shedding;
+#endif
+} Scheduler_t;
+
 /*
  * Init the scheduler.  This function must be called before any other function
  * is used.
@@ -39,19 +127,87 @@ void schedule_init (void);
 /*
  * This function will return a bit field of all tasks that have overrun.  The
  * corresponding task's id in the returned value will be set if the task has
- * overrun during the execution so far.
+ * overrun during the execution so far.  A tick overruns if its tasks have not
+ * returned before the next tick.  All tasks that ran in the tick are then
+ * marked, since the scheduler cannot tell which of them used the time.
  */
 uint32_t schedule_get_overrun_tasks(void);
 
+/*
+ * Returns the number of times the task's run function has been called.  The
+ * counter wraps at 65535.  Returns 0 for an invalid taskid.
+ */
+uint16_t schedule_get_task_runs(uint8_t taskid);
+
 /*
  * Function to add a new task to the scheduler.  The period, offset and the
  * run function must be provided.  The function returns the taskid.  The taskid
  * is a number between 0 and maximum number specified in the config file.
  * Though, the absolute maximum is 32 (taskid 31).  SCHEDULE_INVALID_TASK_ID
  * will be returned if the add function fails.
+ *
+ * If the offset is given as SCHEDULE_OFFSET_AUTO, the scheduler selects the
+ * offset (0 to period-1) that gives the least load in the ticks where the task
+ * will run.  Tasks with a high cost should be added first.
+ *
+ * The slot of a removed task is reused, i.e., the returned taskid may be the
+ * id of a task that has been removed with schedule_remove_task.
  */
 uint8_t schedule_add_task (uint8_t period, uint8_t offset, task_run run_function);
 
+/*
+ * Function to add an event-triggered task to the scheduler.  The task is not
+ * run periodically.  Instead, the run function is called once in the first tick
+ * after schedule_trigger_task has been called for the task.  The function
+ * returns the taskid or SCHEDULE_INVALID_TASK_ID if the add function fails.
+ */
+uint8_t schedule_add_event_task (task_run run_function);
+
+/*
+ * Trigger an event-triggered task.  The task's run function will be called in
+ * the next tick.  Several triggers before the task has run will only run the
+ * task once.  This function may be called from interrupt context.
+ */
+void schedule_trigger_task (uint8_t taskid);
+
+/*
+ * Set the cost of a task.  The cost is a relative weight, e.g., the declared or
+ * measured execution time of the task's run function in a suitable unit.  The
+ * cost is used when the offset for tasks added later is selected automatically.
+ * All tasks have the cost SCHEDULE_DEFAULT_TASK_COST when added.
+ */
+void schedule_set_task_cost (uint8_t taskid, uint8_t cost);
+
+/*
+ * Change the period of a periodic task.  The phase of the task is kept, i.e.,
+ * the task is released in the ticks that are a multiple of the new period from
+ * its next release.  If the new period is shorter than the time to the next
+ * release, the next release is moved forward by a multiple of the new period.
+ * The period of an event-triggered task cannot be changed and a period of 0 is
+ * ignored.
+ */
+void schedule_set_period (uint8_t taskid, uint8_t period);
+
+/*
+ * Suspend a task.  The task's run function is not called until the task is
+ * resumed.  A periodic task keeps its phase while suspended, i.e., it is
+ * resumed in its original ticks.  A trigger of a suspended event-triggered task
+ * is kept and the task runs in the first tick after it has been resumed.
+ */
+void schedule_suspend (uint8_t taskid);
+
+/*
+ * Resume a suspended task.
+ */
+void schedule_resume (uint8_t taskid);
+
+/*
+ * Remove a task from the scheduler.  The task's run function will not be
+ * called again and the taskid may be returned for a task that is added later.
+ * A task may remove itself from its run function.
+ */
+void schedule_remove_task (uint8_t taskid);
+
 /*
  * Start the scheduler.  The scheduler expects that the timer has been
  * configured and initiated.
@@ -64,4 +220,120 @@ void schedule_start (void);
  */
 void schedule_run (void);
 
+#ifdef SCHEDULER_LOAD_METER
+/*
+ * Load meter.
+ *
+ * When SCHEDULER_LOAD_METER is defined, the scheduler measures the part of each
+ * tick that is spent running tasks (busy) versus waiting for the next tick
+ * (idle).  The busy time is read from the timer (TIMER_GET_SUBTICKS) when the
+ * tasks of a tick have returned.  A tick where the tasks did not return before
+ * the next tick counts as 100% load.  All load values are in percent (0-100).
+ */
+
+/*
+ * Returns the load of the last tick.
+ */
+uint8_t schedule_get_load (void);
+
+/*
+ * Returns the average load.  The average is an exponential moving average over
+ * approximately 2^SCHEDULER_LOAD_AVERAGE_SHIFT ticks.
+ */
+uint8_t schedule_get_load_average (void);
+
+/*
+ * Returns the highest load of a single tick since init or the last reset.
+ */
+uint8_t schedule_get_load_peak (void);
+
+/*
+ * Returns the histogram of the load per tick.  The histogram is an array of
+ * SCHEDULER_LOAD_HISTOGRAM_BINS counters.  Bin i counts the ticks with a load
+ * from i*100/bins to (i+1)*100/bins percent.  100% is counted in the last bin.
+ * The counters saturate at 65535.
+ */
+const uint16_t *schedule_get_load_histogram (void);
+
+/*
+ * Reset the peak load and the histogram.
+ */
+void schedule_reset_load_statistics (void);
+#endif // SCHEDULER_LOAD_METER
+
+#ifdef SCHEDULER_LOAD_SHEDDING
+/*
+ * Load shedding.
+ *
+ * When SCHEDULER_LOAD_SHEDDING is defined, the scheduler slows down the tasks
+ * that have been marked as sheddable when the node is overloaded.  When the
+ * average load reaches SCHEDULER_SHED_LOAD_HIGH, the period of each sheddable
+ * task is multiplied by SCHEDULER_SHED_FACTOR (max 255).  When the average
+ * load has dropped to SCHEDULER_SHED_LOAD_LOW, the periods are restored.  The
+ * phase of the tasks is kept (see schedule_set_period).  Tasks that are not
+ * sheddable, e.g., control loops, keep their periods.
+ */
+
+/*
+ * Mark a periodic task as sheddable or not.  A period set with
+ * schedule_set_period while shedding is stretched as well.
+ */
+void schedule_set_sheddable (uint8_t taskid, bool sheddable);
+
+/*
+ * Returns true if the periods of the sheddable tasks are stretched.
+ */
+bool schedule_is_shedding (void);
+#endif // SCHEDULER_LOAD_SHEDDING
+
+/*
+ * Scheduler instances.
+ *
+ * The following functions are the same as the schedule_ functions above, but
+ * operate on the specified instance.  The memory for an instance is provided by
+ * the user and the instance must be initiated with scheduler_init.  An
+ * instance does not use the timer.  Instead, scheduler_tick is called once per
+ * tick.  Different instances may be used from different threads, but each
+ * instance must only be used by one thread at a time.
+ */
+void scheduler_init (Scheduler_t *self);
+uint32_t scheduler_get_overrun_tasks (const Scheduler_t *self);
+uint16_t scheduler_get_task_runs (const Scheduler_t *self, uint8_t taskid);
+uint8_t scheduler_add_task (Scheduler_t *self, uint8_t period, uint8_t offset, task_run run_function);
+uint8_t scheduler_add_event_task (Scheduler_t *self, task_run run_function);
+void scheduler_trigger_task (Scheduler_t *self, uint8_t taskid);
+void scheduler_set_task_cost (Scheduler_t *self, uint8_t taskid, uint8_t cost);
+void scheduler_set_period (Scheduler_t *self, uint8_t taskid, uint8_t period);
+void scheduler_suspend (Scheduler_t *self, uint8_t taskid);
+void scheduler_resume (Scheduler_t *self, uint8_t taskid);
+void scheduler_remove_task (Scheduler_t *self, uint8_t taskid);
+
+/*
+ * Run the tasks that are scheduled for the next tick.  The function does not
+ * wait for the tick, i.e., the caller decides when a tick has passed.  This is
+ * what schedule_run does for the application's instance when the timer has
+ * ticked.  Overruns are only detected by schedule_run.
+ */
+void scheduler_tick (Scheduler_t *self);
+
+#ifdef SCHEDULER_LOAD_METER
+/*
+ * Record the load of the last tick.  The busy time is given in subticks (see
+ * TIMER_SUBTICKS_PER_TICK).  schedule_run records the load of the application's
+ * instance.  For other instances, the load is recorded by the caller of
+ * scheduler_tick, if the load is measured at all.
+ */
+void scheduler_record_load (Scheduler_t *self, uint16_t busy);
+uint8_t scheduler_get_load (const Scheduler_t *self);
+uint8_t scheduler_get_load_average (const Scheduler_t *self);
+uint8_t scheduler_get_load_peak (const Scheduler_t *self);
+const uint16_t *scheduler_get_load_histogram (const Scheduler_t *self);
+void scheduler_reset_load_statistics (Scheduler_t *self);
+#endif // SCHEDULER_LOAD_METER
+
+#ifdef SCHEDULER_LOAD_SHEDDING
+void scheduler_set_sheddable (Scheduler_t *self, uint8_t taskid, bool sheddable);
+bool scheduler_is_shedding (const Scheduler_t *self);
+#endif // SCHEDULER_LOAD_SHEDDING
+
 #endif // BL_SCHEDULER_H
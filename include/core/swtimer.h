@@ -0,0 +1,103 @@
+/*
+ * Software timers for BitLoom.
+ *
+ * The software timer service handles one-shot and periodic timers with
+ * arbitrary 32 bit durations (in ticks), e.g., protocol timeouts, retransmit
+ * timers and delayed actions.  When a timer expires, its callback is called.
+ *
+ * The timers are kept in a hierarchical timing wheel.  Starting and cancelling
+ * a timer are O(1) operations and the cost per tick does not depend on the
+ * number of pending timers.  Timers with long durations are moved (cascaded)
+ * to lower levels of the wheel as the time approaches their expiry.
+ *
+ * The memory for each timer is provided by the user of the timer (typically
+ * a static swtimer_t variable).  The timer must not be modified directly.
+ *
+ * The function swtimer_tick shall be called once per tick, typically from a
+ * scheduler task with period 1.  The callbacks are called from swtimer_tick.
+ * None of the functions may be called from interrupt context.
+ *
+ * The software timers require a swtimer_config.h file with the following
+ * defines:
+ *  * SWTIMER_WHEEL_BITS - Number of bits per level in the timing wheel (1-8)
+ *
+ * Copyright (c) 2021 BlueZephyr
+ *
+ * This software may be modified and distributed under the terms
+ * of the MIT license.  See the LICENSE file for details.
+ *
+ */
+
+#ifndef BL_SWTIMER_H
+#define BL_SWTIMER_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "config/swtimer_config.h"
+
+/*
+ * Prototype for the callback function that is called when a timer expires.
+ * The context is the pointer given when the timer was set up.
+ */
+typedef void (*swtimer_callback)(void *context);
+
+/*
+ * The timer.  The members are internal to the timer service.
+ */
+typedef struct swtimer_t
+{
+    struct swtimer_t *next;
+    struct swtimer_t **pprev;   // Pointer to the pointer pointing at this timer
+    uint32_t expires;
+    uint32_t delay;
+    uint32_t period;
+    swtimer_callback callback;
+    void *context;
+} swtimer_t;
+
+/*
+ * Init the software timer service.  This function must be called before any
+ * other function is used.  All pending timers are discarded.
+ */
+void swtimer_init (void);
+
+/*
+ * Set up a timer with the callback to be called when the timer expires.  The
+ * context is passed to the callback.  This function must be called before a
+ * timer is started and must not be called for an active timer.
+ */
+void swtimer_setup (swtimer_t *timer, swtimer_callback callback, void *context);
+
+/*
+ * Start the timer.  The timer will expire after delay ticks (a delay of 0 is
+ * treated as 1).  If the period is 0, the timer is a one-shot timer.
+ * Otherwise, the timer is restarted and expires every period ticks after the
+ * first expiry.  If the timer is already active, it is restarted with the new
+ * delay and period.
+ */
+void swtimer_start (swtimer_t *timer, uint32_t delay, uint32_t period);
+
+/*
+ * Restart the timer with the delay and period given when it was last started.
+ * Typically used to restart a timeout, e.g., when data has been received.
+ */
+void swtimer_restart (swtimer_t *timer);
+
+/*
+ * Cancel the timer.  Nothing happens if the timer is not active.
+ */
+void swtimer_cancel (swtimer_t *timer);
+
+/*
+ * Returns true if the timer has been started and has not yet expired (or, for
+ * a periodic timer, has not been cancelled).
+ */
+bool swtimer_is_active (const swtimer_t *timer);
+
+/*
+ * Advance the time by one tick and call the callbacks for all timers that
+ * expire.  The callbacks may start, restart and cancel any timer.
+ */
+void swtimer_tick (void);
+
+#endif // BL_SWTIMER_H
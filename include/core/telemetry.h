@@ -0,0 +1,99 @@
+/*
+ * Binary telemetry for BitLoom.
+ *
+ * The telemetry module periodically takes a snapshot of a set of metrics
+ * (e.g., task run counts, overrun tasks, buffer fill levels and error
+ * counters) and sends it as a compact binary frame over the UART.  The frame
+ * is sent in chunks of at most TELEMETRY_BYTES_PER_RUN bytes per call to
+ * telemetry_run to not overload the tick in which the telemetry task runs.
+ *
+ * Each metric is a 32 bit unsigned value that is read by a function given when
+ * the metric is added.  The metrics are encoded in the order they were added.
+ *
+ * Frame format (version 1):
+ *
+ *   Byte   Content
+ *   0      Sync (TELEMETRY_SYNC)
+ *   1      Version (TELEMETRY_VERSION)
+ *   2      Flags (bit 0: keyframe)
+ *   3      Sequence number (incremented for each frame)
+ *   4      Payload length (n)
+ *   5..    Payload - one varint per metric
+ *   5+n    CRC-8 (polynomial 0x07, initial value 0) of bytes 1 to 4+n
+ *
+ * In a keyframe, each varint holds the value of the metric.  In other frames,
+ * it holds the difference from the value in the previous frame (modulo 2^32).
+ * The values are zigzag encoded (0, -1, 1, -2, ... -> 0, 1, 2, 3, ...) and
+ * written as varints, i.e., seven bits per byte, least significant group
+ * first, with bit 7 set in all bytes but the last.  A decoder is found in
+ * tools/telemetry_decode.py.
+ *
+ * The telemetry requires a telemetry_config.h file with the following defines:
+ *  * TELEMETRY_NO_METRICS - Maximum number of metrics (max 50)
+ *  * TELEMETRY_PERIOD - Number of runs between snapshots
+ *  * TELEMETRY_BYTES_PER_RUN - Maximum number of bytes sent per run
+ *  * TELEMETRY_KEYFRAME_INTERVAL - Number of frames between keyframes
+ *  * TELEMETRY_UART_PORT - The UART port to send the frames on
+ *
+ * Copyright (c) 2021 BlueZephyr
+ *
+ * This software may be modified and distributed under the terms
+ * of the MIT license.  See the LICENSE file for details.
+ *
+ */
+
+#ifndef BL_TELEMETRY_H
+#define BL_TELEMETRY_H
+
+#include <stdint.h>
+#include "config/telemetry_config.h"
+
+#define TELEMETRY_SYNC              (uint8_t)0xB1
+#define TELEMETRY_VERSION           (uint8_t)1
+#define TELEMETRY_FLAG_KEYFRAME     (uint8_t)0x01
+#define TELEMETRY_INVALID_METRIC    (uint8_t)0xFF
+
+/*
+ * Prototype for the function that reads the value of a metric.  The index is
+ * the value given when the metric was added, e.g., a taskid.
+ */
+typedef uint32_t (*telemetry_metric)(uint8_t index);
+
+/*
+ * Init the telemetry.  This function must be called before any other function
+ * is used.  All metrics are removed.
+ */
+void telemetry_init (void);
+
+/*
+ * Add a metric to the telemetry.  The metric function is called with the index
+ * when a snapshot is taken.  Returns the position of the metric in the frame or
+ * TELEMETRY_INVALID_METRIC if no more metrics can be added.
+ */
+uint8_t telemetry_add_metric (telemetry_metric metric, uint8_t index);
+
+/*
+ * Metric functions for the scheduler that can be given to telemetry_add_metric.
+ * The run count metric takes the taskid as index.  The index is not used for
+ * the overrun tasks metric.  Other metrics, e.g., buffer fill levels and error
+ * counters, are provided by the application.  Example:
+ *
+ *   telemetry_add_metric(telemetry_metric_overrun_tasks, 0);
+ *   telemetry_add_metric(telemetry_metric_task_runs, blink_task_id);
+ */
+uint32_t telemetry_metric_task_runs (uint8_t taskid);
+uint32_t telemetry_metric_overrun_tasks (uint8_t index);
+
+/*
+ * Let the next frame be a keyframe, e.g., when a receiver has connected.
+ */
+void telemetry_request_keyframe (void);
+
+/*
+ * Run function for the telemetry task.  Shall be called periodically by the
+ * scheduler.  Takes a snapshot every TELEMETRY_PERIOD runs and sends at most
+ * TELEMETRY_BYTES_PER_RUN bytes of the current frame in each run.
+ */
+void telemetry_run (void);
+
+#endif // BL_TELEMETRY_H
@@ -1,7 +1,11 @@
 /*
  * UART driver interface for BitLoom.
  *
- * Copyright (c) 2020 BlueZephyr
+ * The driver handles one or more UART ports.  The ports and the sizes of their
+ * buffers are configured at compile time in uart_config.h (see the template).
+ * Each port is referred to by its id in the calls to the driver and the HAL.
+ *
+ * Copyright (c) 2020-2021 BlueZephyr
  *
  * This software may be modified and distributed under the terms
  * of the MIT license.  See the LICENSE file for details.
@@ -12,17 +16,64 @@
 #define BL_UART_H
 
 #include <stdint.h>
+#include <stdbool.h>
 #include "config/uart_config.h"
 
+/*
+ * Flow control modes (per port in the uart config).  With flow control, the
+ * driver asks the peer to stop sending when the in buffer fill level reaches
+ * UART_RX_STOP_LEVEL and to resume when it has been read down to
+ * UART_RX_RESUME_LEVEL.  The transmission is paused when the peer asks for it.
+ *
+ * UART_FLOW_CONTROL_RTSCTS - The RTS pin (output) is set high to stop the peer.
+ *                            The CTS pin (input) high means that the peer
+ *                            cannot receive.
+ * UART_FLOW_CONTROL_XONXOFF - XOFF/XON characters are sent to stop/resume the
+ *                             peer.  Received XOFF/XON characters pause/resume
+ *                             the transmission and are not stored.
+ */
+#define UART_FLOW_CONTROL_NONE      0
+#define UART_FLOW_CONTROL_RTSCTS    1
+#define UART_FLOW_CONTROL_XONXOFF   2
+
+#define UART_XON                    (uint8_t)0x11
+#define UART_XOFF                   (uint8_t)0x13
+
+/*
+ * The ids of the configured ports.  UART_NO_PORTS is the number of ports.
+ */
+#define UART_PORT_ID(id, in_size, out_size, flow_control, rts_pin, cts_pin) id,
+enum uart_port_t
+{
+    UART_PORTS(UART_PORT_ID)
+    UART_NO_PORTS
+};
+#undef UART_PORT_ID
+
+/*
+ * Statistics for a UART port.  The high-water marks are the highest fill levels
+ * of the buffers (in bytes).  The counters of dropped and rejected bytes
+ * saturate at 65535.
+ */
+typedef struct
+{
+    uint32_t rx_bytes;          // Bytes received and stored in the in buffer
+    uint32_t tx_bytes;          // Bytes accepted by uart_write
+    uint16_t rx_dropped;        // Bytes dropped since the in buffer was full
+    uint16_t tx_rejected;       // Bytes not accepted since the out buffer was full
+    uint16_t rx_high_water;
+    uint16_t tx_high_water;
+} uart_stats_t;
+
 /*
  * Error codes from UART operations:
  */
 
 /*
- * Function to initialize the UART driver.  This function must be called prior
- * to any other function is called.
+ * Function to initialize a UART port.  This function must be called prior
+ * to any other function is called for the port.
  */
-void uart_init (void);
+void uart_init (enum uart_port_t port);
 
 /*
  * Read data from UART.
@@ -33,7 +84,7 @@ void uart_init (void);
  *
  * It is up to the caller to allocate memory for the data in the buffer.
  */
-uint16_t uart_read (uint8_t* buffer, uint16_t nbytes);
+uint16_t uart_read (enum uart_port_t port, uint8_t* buffer, uint16_t nbytes);
 
 /*
  * Write data to UART.
@@ -42,7 +93,59 @@ uint16_t uart_read (uint8_t* buffer, uint16_t nbytes);
  * The function returns the number of written bytes.  A negative number indicates an error
  * according to the error coded defined.
  */
-uint16_t uart_write (uint8_t* buffer, uint16_t nbytes);
+uint16_t uart_write (enum uart_port_t port, uint8_t* buffer, uint16_t nbytes);
+
+/*
+ * Get the statistics of the port.
+ */
+void uart_get_stats (enum uart_port_t port, uart_stats_t *stats);
+
+/*
+ * Reset the statistics.  The high-water marks are set to the current fill
+ * levels of the buffers.
+ */
+void uart_reset_stats (enum uart_port_t port);
+
+/*
+ * The following functions are called by the UART HAL, typically from interrupt
+ * context.  The port is typically a constant in each interrupt handler.
+ */
+
+/*
+ * Called by the HAL for each received byte.  The driver stores the byte in
+ * the in buffer (or drops it if the buffer is full) and handles flow control.
+ */
+void uart_receive_byte (enum uart_port_t port, uint8_t byte);
+
+/*
+ * Called by the HAL before each byte is taken from the out buffer and
+ * transmitted.  Returns false if the peer has asked to pause the transmission.
+ * The HAL shall then stop transmitting until uart_hal_send is called again
+ * (or, for RTS/CTS, until the CTS pin is low).
+ */
+bool uart_transmit_allowed (enum uart_port_t port);
+
+/*
+ * Per-port variants of uart_write, uart_receive_byte and uart_transmit_allowed
+ * for a port that is known at compile time, e.g., in the interrupt handlers of
+ * the port.  They access the state of the port at constant addresses and only
+ * contain the flow control of the port.  The port may be given by a macro.
+ *
+ *   UART_RECEIVE_BYTE(UART_PORT0, UDR0);
+ */
+#define UART_CONCAT(a, b)                   a##b
+#define UART_PORT_FUNCTION(name, port)      UART_CONCAT(name, port)
+
+#define UART_WRITE(port, buffer, nbytes)    UART_PORT_FUNCTION(uart_write_, port)(buffer, nbytes)
+#define UART_RECEIVE_BYTE(port, byte)       UART_PORT_FUNCTION(uart_receive_byte_, port)(byte)
+#define UART_TRANSMIT_ALLOWED(port)         UART_PORT_FUNCTION(uart_transmit_allowed_, port)()
+
+#define UART_PORT_FUNCTIONS(id, in_size, out_size, flow_control, rts_pin, cts_pin) \
+    uint16_t uart_write_##id (uint8_t* buffer, uint16_t nbytes); \
+    void uart_receive_byte_##id (uint8_t byte); \
+    bool uart_transmit_allowed_##id (void);
+UART_PORTS(UART_PORT_FUNCTIONS)
+#undef UART_PORT_FUNCTIONS
 
 #endif // BL_UART_H
 
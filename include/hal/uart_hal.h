@@ -1,7 +1,7 @@
 /*
  * UART interface in the Hardware abstraction layer (HAL) for BitLoom.
  *
- * Copyright (c) 2020 BlueZephyr
+ * Copyright (c) 2020-2021 BlueZephyr
  *
  * This software may be modified and distributed under the terms
  * of the MIT license.  See the LICENSE file for details.
@@ -12,7 +12,7 @@
 #define BL_HAL_UART_H
 
 #include <stdint.h>
-#include "config/uart_config.h"
+#include "core/uart.h"
 #include "bytebuffer.h"
 
 /*
@@ -20,18 +20,30 @@
  */
 
 /*
- * Function to initialize the UART hardware.  This function must be called prior
- * to any other function is called.
+ * Function to initialize the UART hardware of the port.  This function must be
+ * called prior to any other function is called for the port.
  *
- * The function takes two bytebuffers as input - one for writing outgoing data
- * and one for reading incoming data.  It is up to the caller of the function
- * to prepare the buffers before the init function is called.
+ * The function takes the bytebuffer for the outgoing data as input.  It is up
+ * to the caller of the function to prepare the buffer before the init function
+ * is called.  Each received byte shall be passed to uart_receive_byte (see
+ * uart.h).  Before each byte is taken from the outBuffer, the HAL shall call
+ * uart_transmit_allowed and stop transmitting if it returns false.  Interrupt
+ * handlers that serve a single port should use the per-port variants
+ * UART_RECEIVE_BYTE and UART_TRANSMIT_ALLOWED.
  */
-void uart_hal_init(bytebuffer_t *inBuffer, bytebuffer_t *outBuffer);
+void uart_hal_init(enum uart_port_t port, bytebuffer_t *outBuffer);
 
 /*
- * Function to inform the HAL that new data is available in the outBuffer.
+ * Function to inform the HAL that new data is available in the outBuffer or
+ * that a paused transmission may be resumed.
  */
-void uart_hal_send(void);
+void uart_hal_send(enum uart_port_t port);
+
+/*
+ * Function to send a byte ahead of the data in the outBuffer.  Used to send
+ * XON/XOFF characters and only required with UART_FLOW_CONTROL_XONXOFF.  The
+ * byte shall be sent even if the transmission is paused.
+ */
+void uart_hal_send_immediate(enum uart_port_t port, uint8_t byte);
 
 #endif // BL_HAL_UART_H
@@ -0,0 +1,281 @@
+/*
+ * BitLoom Executor - Runs scheduler instances on a pool of threads.
+ *
+ * Copyright (c) 2021. BlueZephyr
+ *
+ * This software may be modified and distributed under the terms
+ * of the MIT license.  See the LICENSE file for details.
+ *
+ */
+
+#include <stddef.h>
+#include "core/executor.h"
+
+/*
+ * The instance and the tick that the calling thread is running
+ */
+static _Thread_local Scheduler_t *current_instance;
+static _Thread_local uint32_t current_tick;
+
+/*
+ * Take the next batch of instances from the front of a range.
+ */
+static bool executor_take (executor_range_t *range, uint32_t *first, uint32_t *last)
+{
+    bool taken = false;
+
+    pthread_mutex_lock(&range->lock);
+    if (range->next < range->end)
+    {
+        *first = range->next;
+        if (range->end - range->next > EXECUTOR_BATCH_SIZE)
+        {
+            range->next += EXECUTOR_BATCH_SIZE;
+        }
+        else
+        {
+            range->next = range->end;
+        }
+        *last = range->next;
+        taken = true;
+    }
+    pthread_mutex_unlock(&range->lock);
+
+    return taken;
+}
+
+/*
+ * Steal half of the remaining instances from the back of another thread's
+ * range and make them the worker's own range.  The threads are tried in order
+ * starting with the next thread.  Returns false if all ranges are empty.
+ */
+static bool executor_steal (executor_worker_t *worker)
+{
+    executor_t *executor = worker->executor;
+    executor_range_t *victim;
+    uint32_t first = 0;
+    uint32_t stolen = 0;
+    uint8_t i;
+
+    for (i=1; (i<executor->no_of_threads) && (stolen == 0); i++)
+    {
+        victim = &executor->workers[(worker->id + i) % executor->no_of_threads].range;
+
+        pthread_mutex_lock(&victim->lock);
+        stolen = (victim->end - victim->next + 1) / 2;
+        victim->end -= stolen;
+        first = victim->end;
+        pthread_mutex_unlock(&victim->lock);
+    }
+
+    if (stolen == 0)
+    {
+        return false;
+    }
+
+    pthread_mutex_lock(&worker->range.lock);
+    worker->range.next = first;
+    worker->range.end = first + stolen;
+    pthread_mutex_unlock(&worker->range.lock);
+    worker->steals++;
+
+    return true;
+}
+
+/*
+ * Tick the instances of the worker's range and the instances that it can steal
+ * until all ranges are empty.
+ */
+static void executor_work (executor_worker_t *worker)
+{
+    executor_t *executor = worker->executor;
+    uint32_t first;
+    uint32_t last;
+
+    current_tick = executor->ticks;
+    do
+    {
+        while (executor_take(&worker->range, &first, &last))
+        {
+            for (; first<last; first++)
+            {
+                current_instance = executor->instances[first];
+                scheduler_tick(current_instance);
+            }
+        }
+    } while (executor_steal(worker));
+    current_instance = NULL;
+}
+
+static void *executor_thread (void *arg)
+{
+    executor_worker_t *worker = arg;
+    executor_t *executor = worker->executor;
+    uint32_t ticks = 0;
+
+    for (;;)
+    {
+        pthread_mutex_lock(&executor->lock);
+        while ((executor->ticks == ticks) && !executor->stop)
+        {
+            pthread_cond_wait(&executor->tick_start, &executor->lock);
+        }
+        if (executor->stop)
+        {
+            pthread_mutex_unlock(&executor->lock);
+            break;
+        }
+        ticks = executor->ticks;
+        pthread_mutex_unlock(&executor->lock);
+
+        executor_work(worker);
+
+        pthread_mutex_lock(&executor->lock);
+        if (--executor->pending == 0)
+        {
+            pthread_cond_signal(&executor->tick_done);
+        }
+        pthread_mutex_unlock(&executor->lock);
+    }
+
+    return NULL;
+}
+
+/*
+ * Stop the threads and join the threads of worker 1 to no_of_threads - 1.
+ */
+static void executor_stop (executor_t *executor, uint8_t no_of_threads)
+{
+    uint8_t worker;
+
+    pthread_mutex_lock(&executor->lock);
+    executor->stop = true;
+    pthread_cond_broadcast(&executor->tick_start);
+    pthread_mutex_unlock(&executor->lock);
+
+    for (worker=1; worker<no_of_threads; worker++)
+    {
+        pthread_join(executor->workers[worker].thread, NULL);
+    }
+}
+
+bool executor_init (executor_t *executor, Scheduler_t * const *instances,
+                    uint32_t no_of_instances, uint8_t no_of_threads)
+{
+    uint8_t worker;
+
+    if ((no_of_threads == 0) || (no_of_threads > EXECUTOR_MAX_THREADS))
+    {
+        return false;
+    }
+
+    executor->instances = instances;
+    executor->no_of_instances = no_of_instances;
+    executor->no_of_threads = no_of_threads;
+    executor->pending = 0;
+    executor->ticks = 0;
+    executor->stop = false;
+    pthread_mutex_init(&executor->lock, NULL);
+    pthread_cond_init(&executor->tick_start, NULL);
+    pthread_cond_init(&executor->tick_done, NULL);
+
+    for (worker=0; worker<no_of_threads; worker++)
+    {
+        executor->workers[worker].executor = executor;
+        executor->workers[worker].id = worker;
+        executor->workers[worker].steals = 0;
+        executor->workers[worker].range.next = 0;
+        executor->workers[worker].range.end = 0;
+        pthread_mutex_init(&executor->workers[worker].range.lock, NULL);
+    }
+
+    // The calling thread is worker 0
+    for (worker=1; worker<no_of_threads; worker++)
+    {
+        if (pthread_create(&executor->workers[worker].thread, NULL,
+                           executor_thread, &executor->workers[worker]) != 0)
+        {
+            executor_stop(executor, worker);
+            executor_destroy(executor);
+            return false;
+        }
+    }
+
+    return true;
+}
+
+void executor_run (executor_t *executor, uint32_t ticks)
+{
+    uint8_t worker;
+    uint32_t tick;
+
+    for (tick=0; tick<ticks; tick++)
+    {
+        pthread_mutex_lock(&executor->lock);
+        for (worker=0; worker<executor->no_of_threads; worker++)
+        {
+            executor->workers[worker].range.next = (uint32_t)
+                ((uint64_t)executor->no_of_instances * worker / executor->no_of_threads);
+            executor->workers[worker].range.end = (uint32_t)
+                ((uint64_t)executor->no_of_instances * (worker + 1) / executor->no_of_threads);
+        }
+        executor->pending = executor->no_of_threads - 1;
+        executor->ticks++;
+        pthread_cond_broadcast(&executor->tick_start);
+        pthread_mutex_unlock(&executor->lock);
+
+        executor_work(&executor->workers[0]);
+
+        pthread_mutex_lock(&executor->lock);
+        while (executor->pending > 0)
+        {
+            pthread_cond_wait(&executor->tick_done, &executor->lock);
+        }
+        pthread_mutex_unlock(&executor->lock);
+    }
+}
+
+uint32_t executor_get_ticks (const executor_t *executor)
+{
+    return executor->ticks;
+}
+
+uint32_t executor_get_steals (const executor_t *executor)
+{
+    uint32_t steals = 0;
+    uint8_t worker;
+
+    for (worker=0; worker<executor->no_of_threads; worker++)
+    {
+        steals += executor->workers[worker].steals;
+    }
+    return steals;
+}
+
+void executor_destroy (executor_t *executor)
+{
+    uint8_t worker;
+
+    if (!executor->stop)
+    {
+        executor_stop(executor, executor->no_of_threads);
+    }
+
+    for (worker=0; worker<executor->no_of_threads; worker++)
+    {
+        pthread_mutex_destroy(&executor->workers[worker].range.lock);
+    }
+    pthread_cond_destroy(&executor->tick_done);
+    pthread_cond_destroy(&executor->tick_start);
+    pthread_mutex_destroy(&executor->lock);
+}
+
+Scheduler_t *executor_current_instance (void)
+{
+    return current_instance;
+}
+
+uint32_t executor_current_tick (void)
+{
+    return current_tick;
+}
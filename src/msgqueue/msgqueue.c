@@ -0,0 +1,113 @@
+/*
+ * BitLoom Message queue - Lock-free single-producer/single-consumer queue of
+ * fixed-size blocks.
+ *
+ * Copyright (c) 2021. BlueZephyr
+ *
+ * This software may be modified and distributed under the terms
+ * of the MIT license.  See the LICENSE file for details.
+ *
+ */
+
+#include <stddef.h>
+#include "core/msgqueue.h"
+#include "core/scheduler.h"
+
+/*
+ * Compiler barrier.  Makes sure that the data in a block (and the ring slot)
+ * has been written before the index that publishes it is updated.  The index
+ * variables are single bytes, so they are read and written atomically also on
+ * 8 bit targets.
+ */
+#define MSGQUEUE_BARRIER()  __asm__ __volatile__("" ::: "memory")
+
+/*
+ * Both rings have one more slot than the number of blocks.  A ring is empty
+ * when head equals tail.  Since there are never more blocks than slots-1, the
+ * rings can never overflow.
+ */
+static void msgqueue_push (void *volatile *ring, volatile uint8_t *head,
+                           uint8_t ring_size, void *block)
+{
+    uint8_t next = *head + 1;
+
+    if (next == ring_size)
+    {
+        next = 0;
+    }
+    ring[*head] = block;
+    MSGQUEUE_BARRIER();
+    *head = next;
+}
+
+static void *msgqueue_pop (void *volatile *ring, uint8_t head,
+                           volatile uint8_t *tail, uint8_t ring_size)
+{
+    uint8_t next;
+    void *block;
+
+    if (*tail == head)
+    {
+        return NULL;
+    }
+
+    block = ring[*tail];
+    MSGQUEUE_BARRIER();
+    next = *tail + 1;
+    if (next == ring_size)
+    {
+        next = 0;
+    }
+    *tail = next;
+    return block;
+}
+
+void msgqueue_init (msgqueue_t *queue, void *blocks, uint16_t block_size,
+                    uint8_t block_count, void **rings)
+{
+    uint8_t i;
+
+    queue->ring_size = block_count + 1;
+    queue->free_ring = rings;
+    queue->msg_ring = rings + queue->ring_size;
+    queue->free_head = 0;
+    queue->free_tail = 0;
+    queue->msg_head = 0;
+    queue->msg_tail = 0;
+    queue->wake_task = SCHEDULE_INVALID_TASK_ID;
+
+    for (i=0; i<block_count; i++)
+    {
+        queue->free_ring[i] = (uint8_t *)blocks + (uint32_t)i * block_size;
+    }
+    queue->free_head = block_count;
+}
+
+void msgqueue_set_wake_task (msgqueue_t *queue, uint8_t taskid)
+{
+    queue->wake_task = taskid;
+}
+
+void *msgqueue_alloc (msgqueue_t *queue)
+{
+    return msgqueue_pop(queue->free_ring, queue->free_head, &queue->free_tail, queue->ring_size);
+}
+
+void msgqueue_post (msgqueue_t *queue, void *block)
+{
+    msgqueue_push(queue->msg_ring, &queue->msg_head, queue->ring_size, block);
+    if (queue->wake_task != SCHEDULE_INVALID_TASK_ID)
+    {
+        schedule_trigger_task(queue->wake_task);
+    }
+}
+
+void *msgqueue_receive (msgqueue_t *queue)
+{
+    return msgqueue_pop(queue->msg_ring, queue->msg_head, &queue->msg_tail, queue->ring_size);
+}
+
+void msgqueue_release (msgqueue_t *queue, void *block)
+{
+    msgqueue_push(queue->free_ring, &queue->free_head, queue->ring_size, block);
+}
@@ -0,0 +1,172 @@
+/*
+ * BitLoom Memory pools - Fixed-size block allocator.
+ *
+ * Copyright (c) 2021. BlueZephyr
+ *
+ * This software may be modified and distributed under the terms
+ * of the MIT license.  See the LICENSE file for details.
+ *
+ */
+
+#include <stddef.h>
+#include "core/pool.h"
+
+/*
+ * The storage of the pools is built of units that are aligned for pointers
+ * and 32 bit data.  Each block is at least one unit, which is needed since
+ * free blocks are linked using the first pointer in the block.
+ */
+typedef union pool_unit_t
+{
+    void *pointer;
+    uint32_t value;
+} pool_unit_t;
+
+#define POOL_UNITS(block_size) \
+    (((block_size) + sizeof(pool_unit_t) - 1) / sizeof(pool_unit_t))
+
+#define POOL_STORAGE(id, block_size, no_of_blocks) \
+    static pool_unit_t id##_storage[POOL_UNITS(block_size) * (no_of_blocks)];
+POOL_TABLE(POOL_STORAGE)
+#undef POOL_STORAGE
+
+typedef struct PoolConfig_t
+{
+    pool_unit_t *storage;
+    uint16_t units;
+    uint16_t block_size;
+    uint16_t no_of_blocks;
+} PoolConfig_t;
+
+#define POOL_CONFIG(id, block_size, no_of_blocks) \
+    { id##_storage, POOL_UNITS(block_size), block_size, no_of_blocks },
+static const PoolConfig_t config[POOL_NO_POOLS] =
+{
+    POOL_TABLE(POOL_CONFIG)
+};
+#undef POOL_CONFIG
+
+typedef struct Pool_t
+{
+    void *free;
+    uint16_t in_use;
+    uint16_t high_water;
+    uint16_t failures;
+} Pool_t;
+static Pool_t self[POOL_NO_POOLS];
+
+void pool_init (void)
+{
+    uint8_t pool;
+    uint16_t block;
+    pool_unit_t *unit;
+
+    for (pool=0; pool<POOL_NO_POOLS; pool++)
+    {
+        // Link the blocks from the last to the first to allocate from the
+        // start of the storage.
+        self[pool].free = NULL;
+        for (block=config[pool].no_of_blocks; block>0; block--)
+        {
+            unit = &config[pool].storage[(uint32_t)(block - 1) * config[pool].units];
+            unit->pointer = self[pool].free;
+            self[pool].free = unit;
+        }
+        self[pool].in_use = 0;
+        self[pool].high_water = 0;
+        self[pool].failures = 0;
+    }
+}
+
+void *pool_alloc (enum pool_id_t pool)
+{
+    pool_unit_t *block;
+
+    if ((unsigned)pool >= POOL_NO_POOLS)
+    {
+        return NULL;
+    }
+
+    POOL_CRITICAL_ENTER();
+    block = (pool_unit_t *)self[pool].free;
+    if (block != NULL)
+    {
+        self[pool].free = block->pointer;
+        if (++self[pool].in_use > self[pool].high_water)
+        {
+            self[pool].high_water = self[pool].in_use;
+        }
+    }
+    else if (self[pool].failures < UINT16_MAX)
+    {
+        self[pool].failures++;
+    }
+    POOL_CRITICAL_EXIT();
+
+    return block;
+}
+
+bool pool_free (enum pool_id_t pool, void *block)
+{
+    uintptr_t offset;
+    uintptr_t block_bytes;
+    bool freed = false;
+
+    if (((unsigned)pool >= POOL_NO_POOLS) || (block == NULL))
+    {
+        return false;
+    }
+
+    // The block must be the start of a block in the pool's storage
+    block_bytes = (uintptr_t)config[pool].units * sizeof(pool_unit_t);
+    offset = (uintptr_t)block - (uintptr_t)config[pool].storage;
+    if ((offset >= block_bytes * config[pool].no_of_blocks) ||
+        ((offset % block_bytes) != 0))
+    {
+        return false;
+    }
+
+    // A free when no block is in use is a double free
+    POOL_CRITICAL_ENTER();
+    if (self[pool].in_use > 0)
+    {
+        ((pool_unit_t *)block)->pointer = self[pool].free;
+        self[pool].free = block;
+        self[pool].in_use--;
+        freed = true;
+    }
+    POOL_CRITICAL_EXIT();
+
+    return freed;
+}
+
+bool pool_get_stats (enum pool_id_t pool, pool_stats_t *stats)
+{
+    if ((unsigned)pool >= POOL_NO_POOLS)
+    {
+        return false;
+    }
+
+    POOL_CRITICAL_ENTER();
+    stats->block_size = config[pool].block_size;
+    stats->no_of_blocks = config[pool].no_of_blocks;
+    stats->in_use = self[pool].in_use;
+    stats->high_water = self[pool].high_water;
+    stats->failures = self[pool].failures;
+    POOL_CRITICAL_EXIT();
+
+    return true;
+}
+
+void pool_reset_stats (enum pool_id_t pool)
+{
+    if ((unsigned)pool >= POOL_NO_POOLS)
+    {
+        return;
+    }
+
+    POOL_CRITICAL_ENTER();
+    self[pool].high_water = self[pool].in_use;
+    self[pool].failures = 0;
+    POOL_CRITICAL_EXIT();
+}
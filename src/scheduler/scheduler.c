@@ -8,40 +8,213 @@
  *
  */
 
+#include <stddef.h>
 #include "hal/timer.h"
 #include "core/scheduler.h"
 
-typedef struct Task_t
+#define TASK_FLAG_FREE          0x01    // The slot of a removed task
+#define TASK_FLAG_SUSPENDED     0x02
+#define TASK_FLAG_SHEDDABLE     0x04
+
+/*
+ * The instance used by the schedule_ functions
+ */
+static Scheduler_t scheduler;
+static Tick_t current_ticks;
+
+void scheduler_init (Scheduler_t *self)
 {
-    uint8_t period;
-    uint8_t time;
-    task_run run;   // The task's run function
-} Task_t;
+    self->no_of_tasks = 0;
+    self->task_error = 0;
+    self->tasks_run = 0;
+#ifdef SCHEDULER_LOAD_METER
+    self->load_meter.load = 0;
+    self->load_meter.average = 0;
+    scheduler_reset_load_statistics(self);
+#endif
+#ifdef SCHEDULER_LOAD_SHEDDING
+    self->shedding = false;
+#endif
+}
 
-typedef struct Scheduler_t
+static uint8_t gcd (uint8_t a, uint8_t b)
 {
-    Task_t tasks[SCHEDULER_NO_TASKS];
-    uint8_t no_of_tasks;
-    uint32_t task_error;
-    Tick_t current_ticks;
-} Scheduler_t;
-static Scheduler_t self;
+    uint8_t t;
 
-void schedule_init (void)
+    while (b != 0)
+    {
+        t = a % b;
+        a = b;
+        b = t;
+    }
+    return a;
+}
+
+/*
+ * Find the offset for a new task with the specified period that collides with
+ * the least load of the already added tasks.
+ *
+ * A task i releases in the ticks time_i + k*period_i (counted from now) and the
+ * new task in the ticks period + offset + k*period.  The two tasks share ticks
+ * if and only if their release ticks are equal modulo g = gcd(period, period_i).
+ * In that case, g/period_i of the new task's releases coincide with task i.
+ * The accumulated load for an offset is hence the sum of cost_i * g / period_i
+ * for all colliding tasks.  This avoids building an occupancy map over the
+ * hyperperiod, which may be far too large for the targets.
+ */
+static uint8_t scheduler_find_offset (const Scheduler_t *self, uint8_t period)
+{
+    uint8_t offset;
+    uint8_t best_offset = 0;
+    uint8_t task;
+    uint8_t g;
+    uint32_t load;
+    uint32_t best_load = UINT32_MAX;
+
+    for (offset=0; offset<period; offset++)
+    {
+        load = 0;
+        for (task=0; task<self->no_of_tasks; task++)
+        {
+            if ((self->tasks[task].period == 0) ||
+                (self->tasks[task].flags & TASK_FLAG_FREE))
+            {
+                continue;
+            }
+
+            g = gcd(period, self->tasks[task].period);
+            if ((offset % g) == (self->tasks[task].time % g))
+            {
+                load += ((uint32_t)self->tasks[task].cost * g << 8) / self->tasks[task].period;
+            }
+        }
+
+        if (load < best_load)
+        {
+            best_load = load;
+            best_offset = offset;
+        }
+    }
+
+    return best_offset;
+}
+
+/*
+ * Returns the task or NULL if the taskid is not the id of an added task.
+ */
+static Task_t *scheduler_get_task (Scheduler_t *self, uint8_t taskid)
 {
-    self.no_of_tasks = 0;
-    self.task_error = 0;
-    self.current_ticks = 0;
+    if ((taskid < self->no_of_tasks) && !(self->tasks[taskid].flags & TASK_FLAG_FREE))
+    {
+        return &self->tasks[taskid];
+    }
+    return NULL;
 }
 
-uint8_t schedule_add_task (uint8_t period, uint8_t offset, task_run run_function)
+/*
+ * Change the period of a task without changing its phase.  The next release is
+ * kept unless it is more than one new period away.  In that case, it is moved
+ * forward to the first tick that is a multiple of the new period before it.
+ */
+static void scheduler_change_period (Task_t *task, uint8_t period)
+{
+    if (task->time > period)
+    {
+        task->time = (uint16_t)((task->time - 1) % period + 1);
+    }
+    task->period = period;
+}
+
+#ifdef SCHEDULER_LOAD_SHEDDING
+static uint8_t scheduler_shed_period (uint8_t period)
+{
+    uint16_t shed_period = (uint16_t)period * SCHEDULER_SHED_FACTOR;
+
+    if (shed_period > UINT8_MAX)
+    {
+        return UINT8_MAX;
+    }
+    return (uint8_t)shed_period;
+}
+
+/*
+ * Returns the period that a task with the specified base period shall use.
+ */
+static uint8_t scheduler_effective_period (const Scheduler_t *self, const Task_t *task, uint8_t base_period)
+{
+    if (self->shedding && (task->flags & TASK_FLAG_SHEDDABLE))
+    {
+        return scheduler_shed_period(base_period);
+    }
+    return base_period;
+}
+
+static void scheduler_set_shedding (Scheduler_t *self, bool shedding)
+{
+    uint8_t task;
+
+    self->shedding = shedding;
+    for (task=0; task<self->no_of_tasks; task++)
+    {
+        if ((self->tasks[task].period != 0) &&
+            ((self->tasks[task].flags & (TASK_FLAG_FREE | TASK_FLAG_SHEDDABLE)) == TASK_FLAG_SHEDDABLE))
+        {
+            scheduler_change_period(&self->tasks[task],
+                scheduler_effective_period(self, &self->tasks[task], self->tasks[task].base_period));
+        }
+    }
+}
+#endif
+
+uint32_t scheduler_get_overrun_tasks (const Scheduler_t *self)
+{
+    return self->task_error;
+}
+
+uint16_t scheduler_get_task_runs (const Scheduler_t *self, uint8_t taskid)
+{
+    if (taskid < self->no_of_tasks)
+    {
+        return self->tasks[taskid].runs;
+    }
+    return 0;
+}
+
+uint8_t scheduler_add_task (Scheduler_t *self, uint8_t period, uint8_t offset, task_run run_function)
 {
-    if(self.no_of_tasks < SCHEDULER_NO_TASKS)
+    uint8_t taskid;
+
+    // Reuse the slot of a removed task, if any
+    for (taskid=0; taskid<self->no_of_tasks; taskid++)
+    {
+        if (self->tasks[taskid].flags & TASK_FLAG_FREE)
+        {
+            break;
+        }
+    }
+
+    if(taskid < SCHEDULER_NO_TASKS)
     {
-        self.tasks[self.no_of_tasks].period = period;
-        self.tasks[self.no_of_tasks].time = period + offset;
-        self.tasks[self.no_of_tasks].run = run_function;
-        return self.no_of_tasks++;
+        if (offset == SCHEDULE_OFFSET_AUTO)
+        {
+            offset = scheduler_find_offset(self, period);
+        }
+
+        self->tasks[taskid].period = period;
+        self->tasks[taskid].time = (uint16_t)period + offset;
+        self->tasks[taskid].cost = SCHEDULE_DEFAULT_TASK_COST;
+        self->tasks[taskid].flags = 0;
+#ifdef SCHEDULER_LOAD_SHEDDING
+        self->tasks[taskid].base_period = period;
+#endif
+        self->tasks[taskid].triggered = 0;
+        self->tasks[taskid].runs = 0;
+        self->tasks[taskid].run = run_function;
+        if (taskid == self->no_of_tasks)
+        {
+            self->no_of_tasks++;
+        }
+        return taskid;
     }
     else
     {
@@ -49,6 +222,283 @@ uint8_t schedule_add_task (uint8_t period, uint8_t offset, task_run run_function
     }
 }
 
+uint8_t scheduler_add_event_task (Scheduler_t *self, task_run run_function)
+{
+    return scheduler_add_task(self, 0, 0, run_function);
+}
+
+void scheduler_trigger_task (Scheduler_t *self, uint8_t taskid)
+{
+    if (taskid < SCHEDULER_NO_TASKS)
+    {
+        self->tasks[taskid].triggered = 1;
+    }
+}
+
+void scheduler_set_task_cost (Scheduler_t *self, uint8_t taskid, uint8_t cost)
+{
+    if (taskid < self->no_of_tasks)
+    {
+        self->tasks[taskid].cost = cost;
+    }
+}
+
+void scheduler_set_period (Scheduler_t *self, uint8_t taskid, uint8_t period)
+{
+    Task_t *task = scheduler_get_task(self, taskid);
+
+    if ((task != NULL) && (task->period != 0) && (period != 0))
+    {
+#ifdef SCHEDULER_LOAD_SHEDDING
+        task->base_period = period;
+        period = scheduler_effective_period(self, task, period);
+#endif
+        scheduler_change_period(task, period);
+    }
+}
+
+void scheduler_suspend (Scheduler_t *self, uint8_t taskid)
+{
+    Task_t *task = scheduler_get_task(self, taskid);
+
+    if (task != NULL)
+    {
+        task->flags |= TASK_FLAG_SUSPENDED;
+    }
+}
+
+void scheduler_resume (Scheduler_t *self, uint8_t taskid)
+{
+    Task_t *task = scheduler_get_task(self, taskid);
+
+    if (task != NULL)
+    {
+        task->flags &= (uint8_t)~TASK_FLAG_SUSPENDED;
+    }
+}
+
+void scheduler_remove_task (Scheduler_t *self, uint8_t taskid)
+{
+    Task_t *task = scheduler_get_task(self, taskid);
+
+    if (task != NULL)
+    {
+        task->flags = TASK_FLAG_FREE;
+
+        // Trailing free slots are not searched or scheduled
+        while ((self->no_of_tasks > 0) &&
+               (self->tasks[self->no_of_tasks - 1].flags & TASK_FLAG_FREE))
+        {
+            self->no_of_tasks--;
+        }
+    }
+}
+
+#ifdef SCHEDULER_LOAD_SHEDDING
+void scheduler_set_sheddable (Scheduler_t *self, uint8_t taskid, bool sheddable)
+{
+    Task_t *task = scheduler_get_task(self, taskid);
+
+    if ((task != NULL) && (task->period != 0))
+    {
+        if (sheddable)
+        {
+            task->flags |= TASK_FLAG_SHEDDABLE;
+        }
+        else
+        {
+            task->flags &= (uint8_t)~TASK_FLAG_SHEDDABLE;
+        }
+        scheduler_change_period(task, scheduler_effective_period(self, task, task->base_period));
+    }
+}
+
+bool scheduler_is_shedding (const Scheduler_t *self)
+{
+    return self->shedding;
+}
+#endif
+
+#ifdef SCHEDULER_LOAD_METER
+void scheduler_record_load (Scheduler_t *self, uint16_t busy)
+{
+    uint8_t load;
+    uint8_t bin;
+
+    if (busy >= TIMER_SUBTICKS_PER_TICK)
+    {
+        load = 100;
+    }
+    else
+    {
+        load = (uint8_t)(((uint32_t)busy * 100) / TIMER_SUBTICKS_PER_TICK);
+    }
+
+    self->load_meter.load = load;
+    if (load > self->load_meter.peak)
+    {
+        self->load_meter.peak = load;
+    }
+
+    self->load_meter.average = (uint16_t)((int32_t)self->load_meter.average +
+        (((int32_t)load << 8) - (int32_t)self->load_meter.average) / (1 << SCHEDULER_LOAD_AVERAGE_SHIFT));
+
+    bin = (uint8_t)(((uint16_t)load * SCHEDULER_LOAD_HISTOGRAM_BINS) / 100);
+    if (bin >= SCHEDULER_LOAD_HISTOGRAM_BINS)
+    {
+        bin = SCHEDULER_LOAD_HISTOGRAM_BINS - 1;
+    }
+    if (self->load_meter.histogram[bin] < UINT16_MAX)
+    {
+        self->load_meter.histogram[bin]++;
+    }
+
+#ifdef SCHEDULER_LOAD_SHEDDING
+    if (!self->shedding && (scheduler_get_load_average(self) >= SCHEDULER_SHED_LOAD_HIGH))
+    {
+        scheduler_set_shedding(self, true);
+    }
+    else if (self->shedding && (scheduler_get_load_average(self) <= SCHEDULER_SHED_LOAD_LOW))
+    {
+        scheduler_set_shedding(self, false);
+    }
+#endif
+}
+
+uint8_t scheduler_get_load (const Scheduler_t *self)
+{
+    return self->load_meter.load;
+}
+
+uint8_t scheduler_get_load_average (const Scheduler_t *self)
+{
+    return (uint8_t)((self->load_meter.average + 128) >> 8);
+}
+
+uint8_t scheduler_get_load_peak (const Scheduler_t *self)
+{
+    return self->load_meter.peak;
+}
+
+const uint16_t *scheduler_get_load_histogram (const Scheduler_t *self)
+{
+    return self->load_meter.histogram;
+}
+
+void scheduler_reset_load_statistics (Scheduler_t *self)
+{
+    uint8_t bin;
+
+    self->load_meter.peak = 0;
+    for (bin=0; bin<SCHEDULER_LOAD_HISTOGRAM_BINS; bin++)
+    {
+        self->load_meter.histogram[bin] = 0;
+    }
+}
+#endif
+
+/*
+ * Run the tasks of one tick.
+ */
+void scheduler_tick (Scheduler_t *self)
+{
+    uint8_t task;
+    uint32_t task_bit = 1;
+
+    self->tasks_run = 0;
+    for (task=0; task<self->no_of_tasks; task++, task_bit <<= 1)
+    {
+        if (self->tasks[task].flags & TASK_FLAG_FREE)
+        {
+            continue;
+        }
+
+        if (self->tasks[task].period == 0)
+        {
+            // Clear the trigger before running the task to not miss a trigger
+            // from an interrupt while the task is running.
+            if (self->tasks[task].triggered &&
+                !(self->tasks[task].flags & TASK_FLAG_SUSPENDED))
+            {
+                self->tasks[task].triggered = 0;
+                self->tasks[task].runs++;
+                self->tasks_run |= task_bit;
+                self->tasks[task].run();
+            }
+        }
+        else if (--self->tasks[task].time == 0)
+        {
+            // A suspended task keeps counting to keep its phase
+            self->tasks[task].time = self->tasks[task].period;
+            if (!(self->tasks[task].flags & TASK_FLAG_SUSPENDED))
+            {
+                self->tasks[task].runs++;
+                self->tasks_run |= task_bit;
+                self->tasks[task].run();
+            }
+        }
+    }
+}
+
+/*
+ * The schedule_ functions use the application's instance.
+ */
+void schedule_init (void)
+{
+    current_ticks = 0;
+    scheduler_init(&scheduler);
+}
+
+uint32_t schedule_get_overrun_tasks(void)
+{
+    return scheduler_get_overrun_tasks(&scheduler);
+}
+
+uint16_t schedule_get_task_runs(uint8_t taskid)
+{
+    return scheduler_get_task_runs(&scheduler, taskid);
+}
+
+uint8_t schedule_add_task (uint8_t period, uint8_t offset, task_run run_function)
+{
+    return scheduler_add_task(&scheduler, period, offset, run_function);
+}
+
+uint8_t schedule_add_event_task (task_run run_function)
+{
+    return scheduler_add_event_task(&scheduler, run_function);
+}
+
+void schedule_trigger_task (uint8_t taskid)
+{
+    scheduler_trigger_task(&scheduler, taskid);
+}
+
+void schedule_set_task_cost (uint8_t taskid, uint8_t cost)
+{
+    scheduler_set_task_cost(&scheduler, taskid, cost);
+}
+
+void schedule_set_period (uint8_t taskid, uint8_t period)
+{
+    scheduler_set_period(&scheduler, taskid, period);
+}
+
+void schedule_suspend (uint8_t taskid)
+{
+    scheduler_suspend(&scheduler, taskid);
+}
+
+void schedule_resume (uint8_t taskid)
+{
+    scheduler_resume(&scheduler, taskid);
+}
+
+void schedule_remove_task (uint8_t taskid)
+{
+    scheduler_remove_task(&scheduler, taskid);
+}
+
 void schedule_start (void)
 {
     timer_start();
@@ -60,22 +510,73 @@ void schedule_start (void)
  */
 void schedule_run (void)
 {
-    uint8_t task;
     Tick_t ticks;
+#ifdef SCHEDULER_LOAD_METER
+    uint16_t busy;
+#endif
 
     do
     {
         ticks = TIMER_GET_TICKS();
-    } while(self.current_ticks == ticks);
-    self.current_ticks = ticks;
+    } while(current_ticks == ticks);
+    current_ticks = ticks;
 
-    for (task=0; task<self.no_of_tasks; task++)
+    scheduler_tick(&scheduler);
+
+#ifdef SCHEDULER_LOAD_METER
+    // Read the subticks before the ticks.  If the tick has changed, the
+    // subticks belong to the next tick.
+    busy = TIMER_GET_SUBTICKS();
+#endif
+    if (TIMER_GET_TICKS() != ticks)
     {
-        if (--self.tasks[task].time == 0)
-        {
-            self.tasks[task].time = self.tasks[task].period;
-            self.tasks[task].run();
-        }
+        // The tasks did not return in time.  The scheduler cannot tell which
+        // of the tasks that ran used the time, so all of them have overrun.
+        scheduler.task_error |= scheduler.tasks_run;
+#ifdef SCHEDULER_LOAD_METER
+        busy = TIMER_SUBTICKS_PER_TICK;
+#endif
     }
+#ifdef SCHEDULER_LOAD_METER
+    scheduler_record_load(&scheduler, busy);
+#endif
+}
+
+#ifdef SCHEDULER_LOAD_METER
+uint8_t schedule_get_load (void)
+{
+    return scheduler_get_load(&scheduler);
 }
 
+uint8_t schedule_get_load_average (void)
+{
+    return scheduler_get_load_average(&scheduler);
+}
+
+uint8_t schedule_get_load_peak (void)
+{
+    return scheduler_get_load_peak(&scheduler);
+}
+
+const uint16_t *schedule_get_load_histogram (void)
+{
+    return scheduler_get_load_histogram(&scheduler);
+}
+
+void schedule_reset_load_statistics (void)
+{
+    scheduler_reset_load_statistics(&scheduler);
+}
+#endif
+
+#ifdef SCHEDULER_LOAD_SHEDDING
+void schedule_set_sheddable (uint8_t taskid, bool sheddable)
+{
+    scheduler_set_sheddable(&scheduler, taskid, sheddable);
+}
+
+bool schedule_is_shedding (void)
+{
+    return scheduler_is_shedding(&scheduler);
+}
+#endif
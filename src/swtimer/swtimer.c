@@ -0,0 +1,190 @@
+/*
+ * BitLoom Software timers - One-shot and periodic timers in a hierarchical
+ * timing wheel.
+ *
+ * Copyright (c) 2021. BlueZephyr
+ *
+ * This software may be modified and distributed under the terms
+ * of the MIT license.  See the LICENSE file for details.
+ *
+ */
+
+#include <stddef.h>
+#include "core/swtimer.h"
+
+#if (SWTIMER_WHEEL_BITS < 1) || (SWTIMER_WHEEL_BITS > 8)
+#error "SWTIMER_WHEEL_BITS must be in the range 1-8"
+#endif
+
+#define SWTIMER_SLOTS   (1u << SWTIMER_WHEEL_BITS)
+#define SWTIMER_MASK    (SWTIMER_SLOTS - 1u)
+#define SWTIMER_LEVELS  ((32 + SWTIMER_WHEEL_BITS - 1) / SWTIMER_WHEEL_BITS)
+
+/*
+ * Each level in the wheel is an array of slots and each slot is a list of
+ * timers.  A timer is stored in the lowest level that can hold the remaining
+ * time to its expiry.  Level 0 holds timers that expire within the coming
+ * 2^bits ticks, level 1 timers that expire within 2^(2*bits) ticks, etc.
+ * Each time the index of a level wraps, the timers in the next slot of the
+ * level above are re-inserted (cascaded) into the lower levels.
+ *
+ * The time (now) is the next tick to be processed.
+ */
+typedef struct SwTimer_t
+{
+    swtimer_t *wheel[SWTIMER_LEVELS][SWTIMER_SLOTS];
+    uint32_t now;
+} SwTimer_t;
+static SwTimer_t self;
+
+static void swtimer_add (swtimer_t *timer)
+{
+    uint32_t delta = timer->expires - self.now;
+    uint8_t level = 0;
+    swtimer_t **slot;
+
+    while ((level < (SWTIMER_LEVELS - 1)) &&
+           (delta >= ((uint32_t)1 << (SWTIMER_WHEEL_BITS * (level + 1)))))
+    {
+        level++;
+    }
+
+    slot = &self.wheel[level][(timer->expires >> (SWTIMER_WHEEL_BITS * level)) & SWTIMER_MASK];
+    timer->next = *slot;
+    if (timer->next != NULL)
+    {
+        timer->next->pprev = &timer->next;
+    }
+    *slot = timer;
+    timer->pprev = slot;
+}
+
+static void swtimer_remove (swtimer_t *timer)
+{
+    *timer->pprev = timer->next;
+    if (timer->next != NULL)
+    {
+        timer->next->pprev = timer->pprev;
+    }
+    timer->next = NULL;
+    timer->pprev = NULL;
+}
+
+/*
+ * Move all timers in the current slot of the level to lower levels.  Returns
+ * the index of the slot.
+ */
+static uint8_t swtimer_cascade (uint8_t level)
+{
+    uint8_t index = (uint8_t)((self.now >> (SWTIMER_WHEEL_BITS * level)) & SWTIMER_MASK);
+    swtimer_t *timer = self.wheel[level][index];
+    swtimer_t *next;
+
+    self.wheel[level][index] = NULL;
+    while (timer != NULL)
+    {
+        next = timer->next;
+        swtimer_add(timer);
+        timer = next;
+    }
+
+    return index;
+}
+
+void swtimer_init (void)
+{
+    uint8_t level;
+    uint16_t slot;
+
+    for (level=0; level<SWTIMER_LEVELS; level++)
+    {
+        for (slot=0; slot<SWTIMER_SLOTS; slot++)
+        {
+            self.wheel[level][slot] = NULL;
+        }
+    }
+    self.now = 0;
+}
+
+void swtimer_setup (swtimer_t *timer, swtimer_callback callback, void *context)
+{
+    timer->next = NULL;
+    timer->pprev = NULL;
+    timer->expires = 0;
+    timer->delay = 1;
+    timer->period = 0;
+    timer->callback = callback;
+    timer->context = context;
+}
+
+void swtimer_start (swtimer_t *timer, uint32_t delay, uint32_t period)
+{
+    timer->delay = (delay == 0) ? 1 : delay;
+    timer->period = period;
+    swtimer_restart(timer);
+}
+
+void swtimer_restart (swtimer_t *timer)
+{
+    if (timer->pprev != NULL)
+    {
+        swtimer_remove(timer);
+    }
+
+    timer->expires = self.now + timer->delay - 1;
+    swtimer_add(timer);
+}
+
+void swtimer_cancel (swtimer_t *timer)
+{
+    if (timer->pprev != NULL)
+    {
+        swtimer_remove(timer);
+    }
+}
+
+bool swtimer_is_active (const swtimer_t *timer)
+{
+    return timer->pprev != NULL;
+}
+
+void swtimer_tick (void)
+{
+    uint8_t index = (uint8_t)(self.now & SWTIMER_MASK);
+    uint8_t level;
+    swtimer_t *expired;
+    swtimer_t *timer;
+
+    if (index == 0)
+    {
+        for (level=1; level<SWTIMER_LEVELS; level++)
+        {
+            if (swtimer_cascade(level) != 0)
+            {
+                break;
+            }
+        }
+    }
+
+    // Move the expired timers to a local list.  This makes it possible for
+    // the callbacks to start and cancel any timer, including the expired ones.
+    expired = self.wheel[0][index];
+    self.wheel[0][index] = NULL;
+    if (expired != NULL)
+    {
+        expired->pprev = &expired;
+    }
+    self.now++;
+
+    while (expired != NULL)
+    {
+        timer = expired;
+        swtimer_remove(timer);
+        if (timer->period != 0)
+        {
+            timer->expires += timer->period;
+            swtimer_add(timer);
+        }
+        timer->callback(timer->context);
+    }
+}
@@ -0,0 +1,171 @@
+/*
+ * BitLoom Telemetry - Compact binary export of metrics over UART.
+ *
+ * Copyright (c) 2021. BlueZephyr
+ *
+ * This software may be modified and distributed under the terms
+ * of the MIT license.  See the LICENSE file for details.
+ *
+ */
+
+#include "core/telemetry.h"
+#include "core/scheduler.h"
+#include "core/uart.h"
+
+#if (TELEMETRY_NO_METRICS < 1) || (TELEMETRY_NO_METRICS > 50)
+#error "TELEMETRY_NO_METRICS must be in the range 1-50"
+#endif
+
+#define TELEMETRY_HEADER_SIZE       5
+#define TELEMETRY_MAX_VARINT_SIZE   5
+#define TELEMETRY_FRAME_SIZE \
+    (TELEMETRY_HEADER_SIZE + TELEMETRY_NO_METRICS * TELEMETRY_MAX_VARINT_SIZE + 1)
+
+typedef struct Metric_t
+{
+    telemetry_metric read;
+    uint8_t index;
+    uint32_t previous;      // Value in the previous frame
+} Metric_t;
+
+typedef struct Telemetry_t
+{
+    Metric_t metrics[TELEMETRY_NO_METRICS];
+    uint8_t no_of_metrics;
+    uint8_t frame[TELEMETRY_FRAME_SIZE];
+    uint16_t frame_length;  // Up to 256 bytes with 50 metrics
+    uint16_t frame_sent;
+    uint8_t sequence;
+    uint8_t frames_to_keyframe;
+    uint16_t runs_to_snapshot;
+} Telemetry_t;
+static Telemetry_t self;
+
+static uint8_t telemetry_crc8 (const uint8_t *data, uint8_t length)
+{
+    uint8_t crc = 0;
+    uint8_t bit;
+
+    while (length--)
+    {
+        crc ^= *data++;
+        for (bit=0; bit<8; bit++)
+        {
+            crc = (crc & 0x80) ? (uint8_t)((crc << 1) ^ 0x07) : (uint8_t)(crc << 1);
+        }
+    }
+    return crc;
+}
+
+/*
+ * Zigzag encode the difference and write it as a varint.  Returns the number
+ * of bytes written.
+ */
+static uint8_t telemetry_put_varint (uint8_t *buffer, uint32_t delta)
+{
+    uint32_t value = (delta & 0x80000000UL) ? ~(delta << 1) : (delta << 1);
+    uint8_t length = 0;
+
+    while (value >= 0x80)
+    {
+        buffer[length++] = (uint8_t)(value | 0x80);
+        value >>= 7;
+    }
+    buffer[length++] = (uint8_t)value;
+    return length;
+}
+
+static void telemetry_snapshot (void)
+{
+    uint8_t keyframe = (self.frames_to_keyframe == 0);
+    uint8_t length = TELEMETRY_HEADER_SIZE;
+    uint8_t metric;
+    uint32_t value;
+
+    for (metric=0; metric<self.no_of_metrics; metric++)
+    {
+        value = self.metrics[metric].read(self.metrics[metric].index);
+        length += telemetry_put_varint(&self.frame[length],
+                                       keyframe ? value : value - self.metrics[metric].previous);
+        self.metrics[metric].previous = value;
+    }
+
+    self.frame[0] = TELEMETRY_SYNC;
+    self.frame[1] = TELEMETRY_VERSION;
+    self.frame[2] = keyframe ? TELEMETRY_FLAG_KEYFRAME : 0;
+    self.frame[3] = self.sequence++;
+    self.frame[4] = length - TELEMETRY_HEADER_SIZE;
+    self.frame[length] = telemetry_crc8(&self.frame[1], length - 1);
+    self.frame_length = (uint16_t)length + 1;
+    self.frame_sent = 0;
+
+    self.frames_to_keyframe = keyframe ? TELEMETRY_KEYFRAME_INTERVAL - 1 : self.frames_to_keyframe - 1;
+}
+
+void telemetry_init (void)
+{
+    self.no_of_metrics = 0;
+    self.frame_length = 0;
+    self.frame_sent = 0;
+    self.sequence = 0;
+    self.frames_to_keyframe = 0;
+    self.runs_to_snapshot = 1;
+}
+
+uint8_t telemetry_add_metric (telemetry_metric metric, uint8_t index)
+{
+    if (self.no_of_metrics < TELEMETRY_NO_METRICS)
+    {
+        self.metrics[self.no_of_metrics].read = metric;
+        self.metrics[self.no_of_metrics].index = index;
+        self.metrics[self.no_of_metrics].previous = 0;
+
+        // The decoder needs the new metric's absolute value
+        self.frames_to_keyframe = 0;
+        return self.no_of_metrics++;
+    }
+    else
+    {
+        return TELEMETRY_INVALID_METRIC;
+    }
+}
+
+uint32_t telemetry_metric_task_runs (uint8_t taskid)
+{
+    return schedule_get_task_runs(taskid);
+}
+
+uint32_t telemetry_metric_overrun_tasks (uint8_t index)
+{
+    (void)index;
+    return schedule_get_overrun_tasks();
+}
+
+void telemetry_request_keyframe (void)
+{
+    self.frames_to_keyframe = 0;
+}
+
+void telemetry_run (void)
+{
+    uint16_t bytes;
+
+    if (--self.runs_to_snapshot == 0)
+    {
+        self.runs_to_snapshot = TELEMETRY_PERIOD;
+        if (self.frame_sent == self.frame_length)
+        {
+            telemetry_snapshot();
+        }
+    }
+
+    bytes = self.frame_length - self.frame_sent;
+    if (bytes > TELEMETRY_BYTES_PER_RUN)
+    {
+        bytes = TELEMETRY_BYTES_PER_RUN;
+    }
+    if (bytes > 0)
+    {
+        self.frame_sent += uart_write(TELEMETRY_UART_PORT, &self.frame[self.frame_sent], bytes);
+    }
+}
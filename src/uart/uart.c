@@ -1,49 +1,180 @@
 /*
  * UART Driver
  *
- * Copyright (c) 2020. BlueZephyr
+ * Copyright (c) 2020-2021. BlueZephyr
  *
  * This software may be modified and distributed under the terms
  * of the MIT license.  See the LICENSE file for details.
  *
  */
 
+#include "core/uart.h"
 #include "hal/uart_hal.h"
 #include "bytebuffer.h"
 
-static uint8_t inBufferData[INBUFFER_DATA_SIZE];
-static uint8_t outBufferData[OUTBUFFER_DATA_SIZE];
+#if UART_FLOW_CONTROL & UART_FLOW_CONTROL_RTSCTS
+#include "hal/pin_digital_io.h"
+#endif
 
+#ifndef UART_RX_STOP_LEVEL
+#define UART_RX_STOP_LEVEL(in_size)     ((in_size) / 4 * 3)
+#endif
+#ifndef UART_RX_RESUME_LEVEL
+#define UART_RX_RESUME_LEVEL(in_size)   ((in_size) / 4)
+#endif
+
+/*
+ * The buffers of each port are sized at compile time.
+ */
+#define UART_PORT_STORAGE(id, in_size, out_size, flow_control, rts_pin, cts_pin) \
+    static uint8_t id##_inBufferData[in_size]; \
+    static uint8_t id##_outBufferData[out_size];
+UART_PORTS(UART_PORT_STORAGE)
+#undef UART_PORT_STORAGE
+
+typedef struct
+{
+    uint8_t *inBufferData;
+    uint8_t *outBufferData;
+    uint16_t inSize;
+    uint16_t outSize;
+    uint8_t flowControl;
+    uint16_t rtsPin;
+    uint16_t ctsPin;
+} uart_config_t;
+
+#define UART_PORT_CONFIG(id, in_size, out_size, flow_control, rts_pin, cts_pin) \
+    { id##_inBufferData, id##_outBufferData, in_size, out_size, flow_control, rts_pin, cts_pin },
+static const uart_config_t config[UART_NO_PORTS] =
+{
+    UART_PORTS(UART_PORT_CONFIG)
+};
+#undef UART_PORT_CONFIG
+
+/*
+ * The state of a port.  The sizes used in the per-byte functions are copied
+ * from the config, so that all accesses for a port are relative to one
+ * pointer.  The flow control mode is taken from the config, so that the
+ * branches of the other modes are removed when the port is a constant.
+ */
 typedef struct
 {
     bytebuffer_t inBuffer;
     bytebuffer_t outBuffer;
+    uint16_t inSize;
+    uint16_t outSize;
+    uart_stats_t stats;
+#if UART_FLOW_CONTROL != UART_FLOW_CONTROL_NONE
+    uint16_t rxStopLevel;
+    uint16_t rxResumeLevel;
+    volatile bool rxStopped;    // The peer has been asked to stop sending
+#endif
+#if UART_FLOW_CONTROL & UART_FLOW_CONTROL_XONXOFF
+    volatile bool txPaused;     // The peer has sent XOFF
+#endif
 } uart_t;
-static uart_t self;
+static uart_t self[UART_NO_PORTS];
 
-void uart_init (void)
+#if UART_FLOW_CONTROL != UART_FLOW_CONTROL_NONE
+static void uart_stop_peer (enum uart_port_t port, uart_t *uart)
 {
-    bytebuffer_init(&self.inBuffer, inBufferData, INBUFFER_DATA_SIZE);
-    bytebuffer_init(&self.outBuffer, outBufferData, OUTBUFFER_DATA_SIZE);
-    uart_hal_init(&self.inBuffer, &self.outBuffer);
+    uart->rxStopped = true;
+#if UART_FLOW_CONTROL & UART_FLOW_CONTROL_RTSCTS
+    if (config[port].flowControl == UART_FLOW_CONTROL_RTSCTS)
+    {
+        pin_digital_io_write_high(config[port].rtsPin);
+    }
+#endif
+#if UART_FLOW_CONTROL & UART_FLOW_CONTROL_XONXOFF
+    if (config[port].flowControl == UART_FLOW_CONTROL_XONXOFF)
+    {
+        uart_hal_send_immediate(port, UART_XOFF);
+    }
+#endif
 }
 
-uint16_t uart_read (uint8_t* buffer, uint16_t nbytes)
+static void uart_resume_peer (enum uart_port_t port, uart_t *uart)
 {
-    (void)nbytes;
-    if (!bytebuffer_isEmpty(&self.inBuffer))
+    uart->rxStopped = false;
+#if UART_FLOW_CONTROL & UART_FLOW_CONTROL_RTSCTS
+    if (config[port].flowControl == UART_FLOW_CONTROL_RTSCTS)
+    {
+        pin_digital_io_write_low(config[port].rtsPin);
+    }
+#endif
+#if UART_FLOW_CONTROL & UART_FLOW_CONTROL_XONXOFF
+    if (config[port].flowControl == UART_FLOW_CONTROL_XONXOFF)
     {
-        *buffer = bytebuffer_read(&self.inBuffer);
-        return 1;
+        uart_hal_send_immediate(port, UART_XON);
     }
+#endif
+}
+#endif
+
+void uart_init (enum uart_port_t port)
+{
+    uart_t *uart = &self[port];
 
-    return 0;
+    uart->inSize = config[port].inSize;
+    uart->outSize = config[port].outSize;
+    bytebuffer_init(&uart->inBuffer, config[port].inBufferData, uart->inSize);
+    bytebuffer_init(&uart->outBuffer, config[port].outBufferData, uart->outSize);
+    uart->stats.rx_bytes = 0;
+    uart->stats.tx_bytes = 0;
+    uart->stats.rx_dropped = 0;
+    uart->stats.tx_rejected = 0;
+    uart->stats.rx_high_water = 0;
+    uart->stats.tx_high_water = 0;
+#if UART_FLOW_CONTROL != UART_FLOW_CONTROL_NONE
+    uart->rxStopLevel = UART_RX_STOP_LEVEL(uart->inSize);
+    uart->rxResumeLevel = UART_RX_RESUME_LEVEL(uart->inSize);
+#endif
+#if UART_FLOW_CONTROL & UART_FLOW_CONTROL_XONXOFF
+    uart->txPaused = false;
+#endif
+    uart_hal_init(port, &uart->outBuffer);
+#if UART_FLOW_CONTROL != UART_FLOW_CONTROL_NONE
+    if (config[port].flowControl != UART_FLOW_CONTROL_NONE)
+    {
+        uart_resume_peer(port, uart);
+    }
+#endif
 }
 
-uint16_t uart_write (uint8_t* buffer, uint16_t nbytes)
+uint16_t uart_read (enum uart_port_t port, uint8_t* buffer, uint16_t nbytes)
 {
+    uart_t *uart = &self[port];
+    uint16_t i;
+
+    for (i=0; (i<nbytes) && !bytebuffer_isEmpty(&uart->inBuffer); i++)
+    {
+        buffer[i] = bytebuffer_read(&uart->inBuffer);
+    }
+
+#if UART_FLOW_CONTROL != UART_FLOW_CONTROL_NONE
+    if (uart->rxStopped &&
+        ((uart->inSize - bytebuffer_getSpace(&uart->inBuffer)) <= uart->rxResumeLevel))
+    {
+        uart_resume_peer(port, uart);
+    }
+#endif
+
+    return i;
+}
+
+/*
+ * The bodies of uart_write, uart_receive_byte and uart_transmit_allowed.  They
+ * are inlined both in the functions that take the port as a parameter and in
+ * the per-port functions below, where the port is a constant.
+ */
+static inline uint16_t uart_write_inline (enum uart_port_t port, uint8_t* buffer, uint16_t nbytes)
+{
+    uart_t *uart = &self[port];
+
     // Calculate available space in the send buffer
-    uint16_t bytesToWrite = bytebuffer_getSpace(&self.outBuffer);
+    uint16_t space = bytebuffer_getSpace(&uart->outBuffer);
+    uint16_t bytesToWrite = space;
+    uint16_t fill;
     uint16_t i;
 
     if (bytesToWrite > nbytes)
@@ -53,13 +184,153 @@ uint16_t uart_write (uint8_t* buffer, uint16_t nbytes)
 
     for (i=0; i<bytesToWrite; i++)
     {
-        bytebuffer_write(&self.outBuffer, buffer[i]);
+        bytebuffer_write(&uart->outBuffer, buffer[i]);
     }
 
     if (bytesToWrite > 0)
     {
-        uart_hal_send();
+        uart_hal_send(port);
+    }
+
+    // The out buffer is only filled here, so the fill level after the write
+    // is the peak.  The counters are only written in task context.
+    fill = uart->outSize - space + bytesToWrite;
+    if (fill > uart->stats.tx_high_water)
+    {
+        uart->stats.tx_high_water = fill;
+    }
+    uart->stats.tx_bytes += bytesToWrite;
+    if ((uint32_t)uart->stats.tx_rejected + (nbytes - bytesToWrite) > UINT16_MAX)
+    {
+        uart->stats.tx_rejected = UINT16_MAX;
+    }
+    else
+    {
+        uart->stats.tx_rejected += nbytes - bytesToWrite;
     }
 
     return bytesToWrite;
 }
+
+static inline void uart_receive_byte_inline (enum uart_port_t port, uint8_t byte)
+{
+    uart_t *uart = &self[port];
+    uint16_t space;
+    uint16_t fill;
+
+#if UART_FLOW_CONTROL & UART_FLOW_CONTROL_XONXOFF
+    if (config[port].flowControl == UART_FLOW_CONTROL_XONXOFF)
+    {
+        if (byte == UART_XOFF)
+        {
+            uart->txPaused = true;
+            return;
+        }
+        if (byte == UART_XON)
+        {
+            uart->txPaused = false;
+            uart_hal_send(port);
+            return;
+        }
+    }
+#endif
+
+    space = bytebuffer_getSpace(&uart->inBuffer);
+    if (space == 0)
+    {
+        if (uart->stats.rx_dropped < UINT16_MAX)
+        {
+            uart->stats.rx_dropped++;
+        }
+        return;
+    }
+
+    bytebuffer_write(&uart->inBuffer, byte);
+    uart->stats.rx_bytes++;
+    fill = uart->inSize - space + 1;
+    if (fill > uart->stats.rx_high_water)
+    {
+        uart->stats.rx_high_water = fill;
+    }
+
+#if UART_FLOW_CONTROL != UART_FLOW_CONTROL_NONE
+    if ((config[port].flowControl != UART_FLOW_CONTROL_NONE) &&
+        !uart->rxStopped && (fill >= uart->rxStopLevel))
+    {
+        uart_stop_peer(port, uart);
+    }
+#endif
+}
+
+static inline bool uart_transmit_allowed_inline (enum uart_port_t port)
+{
+#if UART_FLOW_CONTROL & UART_FLOW_CONTROL_RTSCTS
+    if (config[port].flowControl == UART_FLOW_CONTROL_RTSCTS)
+    {
+        return !pin_digital_io_read(config[port].ctsPin);
+    }
+#endif
+#if UART_FLOW_CONTROL & UART_FLOW_CONTROL_XONXOFF
+    if (config[port].flowControl == UART_FLOW_CONTROL_XONXOFF)
+    {
+        return !self[port].txPaused;
+    }
+#endif
+    (void)port;
+    return true;
+}
+
+uint16_t uart_write (enum uart_port_t port, uint8_t* buffer, uint16_t nbytes)
+{
+    return uart_write_inline(port, buffer, nbytes);
+}
+
+void uart_get_stats (enum uart_port_t port, uart_stats_t *stats)
+{
+    UART_CRITICAL_ENTER();
+    *stats = self[port].stats;
+    UART_CRITICAL_EXIT();
+}
+
+void uart_reset_stats (enum uart_port_t port)
+{
+    uart_t *uart = &self[port];
+
+    UART_CRITICAL_ENTER();
+    uart->stats.rx_bytes = 0;
+    uart->stats.tx_bytes = 0;
+    uart->stats.rx_dropped = 0;
+    uart->stats.tx_rejected = 0;
+    uart->stats.rx_high_water = uart->inSize - bytebuffer_getSpace(&uart->inBuffer);
+    uart->stats.tx_high_water = uart->outSize - bytebuffer_getSpace(&uart->outBuffer);
+    UART_CRITICAL_EXIT();
+}
+
+void uart_receive_byte (enum uart_port_t port, uint8_t byte)
+{
+    uart_receive_byte_inline(port, byte);
+}
+
+bool uart_transmit_allowed (enum uart_port_t port)
+{
+    return uart_transmit_allowed_inline(port);
+}
+
+/*
+ * The per-port functions (see UART_WRITE etc. in uart.h)
+ */
+#define UART_PORT_FUNCTIONS(id, in_size, out_size, flow_control, rts_pin, cts_pin) \
+    uint16_t uart_write_##id (uint8_t* buffer, uint16_t nbytes) \
+    { \
+        return uart_write_inline(id, buffer, nbytes); \
+    } \
+    void uart_receive_byte_##id (uint8_t byte) \
+    { \
+        uart_receive_byte_inline(id, byte); \
+    } \
+    bool uart_transmit_allowed_##id (void) \
+    { \
+        return uart_transmit_allowed_inline(id); \
+    }
+UART_PORTS(UART_PORT_FUNCTIONS)
+#undef UART_PORT_FUNCTIONS
@@ -0,0 +1,17 @@
+#ifndef EXECUTOR_CONFIG_H
+#define EXECUTOR_CONFIG_H
+
+/*
+ * The maximum number of threads of an executor.  Memory for the state of each
+ * thread is reserved in the executor.  Typically the number of cores.
+ */
+#define EXECUTOR_MAX_THREADS    <1-255>
+
+/*
+ * The number of instances that a thread takes from its range at a time.  A
+ * larger value gives less locking but coarser balancing of the load between
+ * the threads.
+ */
+#define EXECUTOR_BATCH_SIZE     <1->
+
+#endif  // EXECUTOR_CONFIG_H
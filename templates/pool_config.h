@@ -0,0 +1,29 @@
+#ifndef POOL_CONFIG_H
+#define POOL_CONFIG_H
+
+/*
+ * The memory pools are listed in the POOL_TABLE macro.  Each pool is given by
+ * an entry X(id, block_size, no_of_blocks) where the id is the name used to
+ * refer to the pool in the pool API, the block_size is the size of each block
+ * in bytes and no_of_blocks is the number of blocks in the pool (max 65535).
+ * At least one pool must be defined.  Example:
+ *
+ * #define POOL_TABLE(X) \
+ *     X(POOL_SMALL, 16, 8) \
+ *     X(POOL_FRAME, 64, 4)
+ */
+#define POOL_TABLE(X) <pool entries>
+
+/*
+ * The pools can be used from both interrupt and task context.  The allocation
+ * and free operations are protected by the critical section defined by the
+ * following macros.  Typically, the interrupts are disabled in the critical
+ * section.  The enter macro may declare local variables, e.g., for AVR:
+ *
+ * #define POOL_CRITICAL_ENTER()   uint8_t pool_sreg = SREG; cli()
+ * #define POOL_CRITICAL_EXIT()    SREG = pool_sreg
+ */
+#define POOL_CRITICAL_ENTER()   <enter critical section>
+#define POOL_CRITICAL_EXIT()    <exit critical section>
+
+#endif  // POOL_CONFIG_H
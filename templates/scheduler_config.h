@@ -8,4 +8,31 @@
  */
 #define SCHEDULER_NO_TASKS      <1-32>
 
+/*
+ * Define SCHEDULER_LOAD_METER to let the scheduler measure the CPU load, i.e.,
+ * the part of each tick that is spent running tasks.  The load meter requires
+ * TIMER_GET_SUBTICKS() and TIMER_SUBTICKS_PER_TICK in the timer config.
+ *
+ * The average load is an exponential moving average over approximately
+ * 2^SCHEDULER_LOAD_AVERAGE_SHIFT ticks (default 4).  The histogram of the load
+ * per tick has SCHEDULER_LOAD_HISTOGRAM_BINS bins (default 10).
+ */
+// #define SCHEDULER_LOAD_METER
+// #define SCHEDULER_LOAD_AVERAGE_SHIFT    <0-8>
+// #define SCHEDULER_LOAD_HISTOGRAM_BINS   <1-100>
+
+/*
+ * Define SCHEDULER_LOAD_SHEDDING to let the scheduler stretch the periods of
+ * the sheddable tasks when the average load is high (see schedule_set_sheddable).
+ * Load shedding requires SCHEDULER_LOAD_METER.
+ *
+ * The periods are multiplied by SCHEDULER_SHED_FACTOR (default 2) when the
+ * average load reaches SCHEDULER_SHED_LOAD_HIGH percent (default 90) and are
+ * restored when it has dropped to SCHEDULER_SHED_LOAD_LOW percent (default 70).
+ */
+// #define SCHEDULER_LOAD_SHEDDING
+// #define SCHEDULER_SHED_LOAD_HIGH        <1-100>
+// #define SCHEDULER_SHED_LOAD_LOW         <0-99>
+// #define SCHEDULER_SHED_FACTOR           <2-255>
+
 #endif  // SCHEDULER_CONFIG_H
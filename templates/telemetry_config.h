@@ -0,0 +1,37 @@
+#ifndef TELEMETRY_CONFIG_H
+#define TELEMETRY_CONFIG_H
+
+/*
+ * The maximum number of metrics that can be added to the telemetry.  For each
+ * metric, memory is reserved for its state and for its part of the frame.  The
+ * maximum number of metrics is 50.
+ */
+#define TELEMETRY_NO_METRICS            <1-50>
+
+/*
+ * The number of calls to telemetry_run between two snapshots of the metrics,
+ * i.e., the telemetry period is the period of the telemetry task times this
+ * value.  If the previous frame has not been sent, the snapshot is skipped.
+ */
+#define TELEMETRY_PERIOD                <1-65535>
+
+/*
+ * The maximum number of bytes written to the UART in each call to
+ * telemetry_run.  Should be chosen so that the bytes can be transmitted within
+ * the period of the telemetry task.
+ */
+#define TELEMETRY_BYTES_PER_RUN         <1-255>
+
+/*
+ * Every TELEMETRY_KEYFRAME_INTERVAL frame is a keyframe that holds the absolute
+ * values of the metrics.  The other frames hold the changes since the previous
+ * frame.  The keyframes let the receiver synchronize.
+ */
+#define TELEMETRY_KEYFRAME_INTERVAL     <1-255>
+
+/*
+ * The UART port (see uart_config.h) that the frames are sent on.
+ */
+#define TELEMETRY_UART_PORT             <uart port id>
+
+#endif  // TELEMETRY_CONFIG_H
@@ -17,6 +17,12 @@
  * - Tick_t (unsigned int of appropriate type)
  * - TIMER_GET_TICKS()
  *
+ * If the scheduler's load meter is used (SCHEDULER_LOAD_METER), the following
+ * must also be defined:
+ * - TIMER_GET_SUBTICKS() - The time since the start of the current tick, e.g.,
+ *                          the counter register of the hardware timer
+ * - TIMER_SUBTICKS_PER_TICK - The number of subticks per tick (max 65535)
+ *
  */
 
 #endif  // TIMER_CONFIG_H
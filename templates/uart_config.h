@@ -2,12 +2,51 @@
 #define UART_CONFIG_H
 
 /*
- * The UART module uses two byte buffers for incoming and outgoing data.  The sizes of the buffers
- * must be specified.  The buffers are implemented using the bytebuffer module in cutil.  Hence,
- * the sizes must be a power of two.  Maximum size is 32768.
+ * The UART ports are listed in the UART_PORTS macro.  Each port is given by an
+ * entry X(id, in_size, out_size, flow_control, rts_pin, cts_pin) where:
+ *  * id - The name used to refer to the port in the UART API and the HAL
+ *  * in_size/out_size - The sizes of the buffers for incoming and outgoing
+ *    data.  The buffers are implemented using the bytebuffer module in cutil.
+ *    Hence, the sizes must be a power of two.  Maximum size is 32768.
+ *  * flow_control - UART_FLOW_CONTROL_NONE, UART_FLOW_CONTROL_RTSCTS or
+ *    UART_FLOW_CONTROL_XONXOFF (see uart.h)
+ *  * rts_pin/cts_pin - The pin ids (see pin_digital_io.h) of the RTS and CTS
+ *    pins for RTS/CTS flow control.  Not used for the other modes.
+ * At least one port must be defined.  Example:
+ *
+ * #define UART_PORTS(X) \
+ *     X(UART_DEBUG,    64,  64, UART_FLOW_CONTROL_NONE,   0, 0) \
+ *     X(UART_GATEWAY, 256, 128, UART_FLOW_CONTROL_RTSCTS, 12, 13)
  */
+#define UART_PORTS(X) <port entries>
 
-#define INBUFFER_DATA_SIZE  <set-value>
-#define OUTBUFFER_DATA_SIZE <set-value>
+/*
+ * The flow control modes used by any of the ports, or:ed together.  Support
+ * for other modes is not compiled.  Use UART_FLOW_CONTROL_NONE if no port uses
+ * flow control.
+ */
+#define UART_FLOW_CONTROL       <UART_FLOW_CONTROL_NONE/RTSCTS/XONXOFF>
+
+/*
+ * With flow control, the peer is asked to stop sending when the in buffer holds
+ * UART_RX_STOP_LEVEL(in_size) bytes and to resume when it holds
+ * UART_RX_RESUME_LEVEL(in_size) bytes.  The stop level shall leave room for
+ * the bytes the peer sends before it stops.  Default levels are 3/4 and 1/4 of
+ * the in buffer.
+ */
+// #define UART_RX_STOP_LEVEL(in_size)      <bytes>
+// #define UART_RX_RESUME_LEVEL(in_size)    <bytes>
+
+/*
+ * The statistics are updated from interrupt context.  The critical section
+ * protects them when they are read by the application.  Typically, the
+ * interrupts are disabled in the critical section.  The enter macro may
+ * declare local variables, e.g., for AVR:
+ *
+ * #define UART_CRITICAL_ENTER()   uint8_t uart_sreg = SREG; cli()
+ * #define UART_CRITICAL_EXIT()    SREG = uart_sreg
+ */
+#define UART_CRITICAL_ENTER()   <enter critical section>
+#define UART_CRITICAL_EXIT()    <exit critical section>
 
 #endif  // UART_CONFIG_H
@@ -0,0 +1,21 @@
+#ifndef POOL_CONFIG_H
+#define POOL_CONFIG_H
+
+/*
+ * The memory pools are listed in the POOL_TABLE macro.  Each pool is given by
+ * an entry X(id, block_size, no_of_blocks) where the id is the name used to
+ * refer to the pool in the pool API, the block_size is the size of each block
+ * in bytes and no_of_blocks is the number of blocks in the pool (max 65535).
+ * At least one pool must be defined.
+ */
+#define POOL_TABLE(X) \
+    X(POOL_SMALL, 3, 4) \
+    X(POOL_LARGE, 64, 2)
+
+/*
+ * The unit tests run in one context only.
+ */
+#define POOL_CRITICAL_ENTER()
+#define POOL_CRITICAL_EXIT()
+
+#endif  // POOL_CONFIG_H
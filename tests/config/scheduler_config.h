@@ -8,4 +8,22 @@
  */
 #define SCHEDULER_NO_TASKS      32
 
+/*
+ * Define SCHEDULER_LOAD_METER to let the scheduler measure the CPU load, i.e.,
+ * the part of each tick that is spent running tasks.  The load meter requires
+ * TIMER_GET_SUBTICKS() and TIMER_SUBTICKS_PER_TICK in the timer config.
+ */
+#define SCHEDULER_LOAD_METER
+#define SCHEDULER_LOAD_AVERAGE_SHIFT    2
+#define SCHEDULER_LOAD_HISTOGRAM_BINS   10
+
+/*
+ * Define SCHEDULER_LOAD_SHEDDING to let the scheduler stretch the periods of
+ * the sheddable tasks when the average load is high.
+ */
+#define SCHEDULER_LOAD_SHEDDING
+#define SCHEDULER_SHED_LOAD_HIGH        80
+#define SCHEDULER_SHED_LOAD_LOW         50
+#define SCHEDULER_SHED_FACTOR           4
+
 #endif  // SCHEDULER_CONFIG_H
@@ -0,0 +1,13 @@
+#ifndef SWTIMER_CONFIG_H
+#define SWTIMER_CONFIG_H
+
+/*
+ * The software timers are kept in a hierarchical timing wheel.  Each level of
+ * the wheel has 2^SWTIMER_WHEEL_BITS slots and the number of levels is chosen
+ * to cover 32 bit durations.  Each slot requires memory for one pointer, i.e.,
+ * the wheel requires ceil(32/bits) * 2^bits pointers.  A larger value gives
+ * fewer cascades of long timers but requires more memory.  Range 1-8.
+ */
+#define SWTIMER_WHEEL_BITS      4
+
+#endif  // SWTIMER_CONFIG_H
@@ -17,4 +17,8 @@
 Tick_t timer_get_ticks(void);
 #define TIMER_GET_TICKS() timer_get_ticks()
 
+uint16_t timer_get_subticks(void);
+#define TIMER_GET_SUBTICKS() timer_get_subticks()
+#define TIMER_SUBTICKS_PER_TICK 1000
+
 #endif  // TIMER_CONFIG_H
@@ -0,0 +1,20 @@
+#ifndef UART_CONFIG_H
+#define UART_CONFIG_H
+
+/*
+ * The UART ports are listed in the UART_PORTS macro.  Each port is given by an
+ * entry X(id, in_size, out_size, flow_control, rts_pin, cts_pin).  See the
+ * template for details.
+ */
+#define UART_PORTS(X) \
+    X(UART_PORT0, 64, 64, UART_FLOW_CONTROL_NONE, 0, 0) \
+    X(UART_PORT1, 16, 32, UART_FLOW_CONTROL_NONE, 0, 0) \
+    X(UART_PORT2, 8, 8, UART_FLOW_CONTROL_RTSCTS, 1, 2) \
+    X(UART_PORT3, 8, 8, UART_FLOW_CONTROL_XONXOFF, 0, 0)
+
+#define UART_FLOW_CONTROL       (UART_FLOW_CONTROL_RTSCTS | UART_FLOW_CONTROL_XONXOFF)
+
+#define UART_CRITICAL_ENTER()
+#define UART_CRITICAL_EXIT()
+
+#endif  // UART_CONFIG_H
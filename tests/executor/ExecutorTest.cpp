@@ -0,0 +1,228 @@
+/*
+ * Unit tests for the Bit Loom host executor.
+ *
+ * Copyright (c) 2021. BlueZephyr
+ *
+ * This software may be modified and distributed under the terms
+ * of the MIT license.  See the LICENSE file for details.
+ *
+ */
+
+#include <time.h>
+#include "CppUTest/CommandLineTestRunner.h"
+
+extern "C"
+{
+    #include "core/executor.h"
+}
+
+#define NO_OF_NODES     64
+
+/*
+ * A simulated node.  The scheduler instance is the first member so that the
+ * tasks can get their node from the current instance.
+ */
+typedef struct
+{
+    Scheduler_t scheduler;
+    uint32_t runs;
+    uint32_t last_tick;
+    uint32_t tick_errors;
+} Node_t;
+
+static Node_t nodes[NO_OF_NODES];
+static Scheduler_t *instances[NO_OF_NODES];
+
+static Node_t *current_node (void)
+{
+    return (Node_t *)executor_current_instance();
+}
+
+static void count_task (void)
+{
+    Node_t *node = current_node();
+
+    node->runs++;
+    node->last_tick = executor_current_tick();
+}
+
+/*
+ * Checks that the task is run once in every tick of the virtual clock.
+ */
+static void every_tick_task (void)
+{
+    Node_t *node = current_node();
+
+    if (executor_current_tick() != node->last_tick + 1)
+    {
+        node->tick_errors++;
+    }
+    count_task();
+}
+
+static void slow_task (void)
+{
+    struct timespec delay = { 0, 5000000 };
+
+    nanosleep(&delay, NULL);
+    count_task();
+}
+
+TEST_GROUP(executor)
+{
+    executor_t executor;
+
+    void setup() override
+    {
+        uint32_t i;
+
+        for (i = 0; i < NO_OF_NODES; i++)
+        {
+            scheduler_init(&nodes[i].scheduler);
+            nodes[i].runs = 0;
+            nodes[i].last_tick = 0;
+            nodes[i].tick_errors = 0;
+            instances[i] = &nodes[i].scheduler;
+        }
+    }
+
+    void add_task_to_all_nodes(task_run run)
+    {
+        uint32_t i;
+
+        for (i = 0; i < NO_OF_NODES; i++)
+        {
+            scheduler_add_task(&nodes[i].scheduler, 1, 0, run);
+        }
+    }
+};
+
+
+/*
+ * TEST CASES
+ */
+TEST(executor, init_with_invalid_no_of_threads_fails)
+{
+    CHECK_FALSE(executor_init(&executor, instances, NO_OF_NODES, 0));
+    CHECK_FALSE(executor_init(&executor, instances, NO_OF_NODES, EXECUTOR_MAX_THREADS + 1));
+}
+
+TEST(executor, no_ticks_after_init)
+{
+    CHECK_TRUE(executor_init(&executor, instances, NO_OF_NODES, 4));
+    LONGS_EQUAL(0, executor_get_ticks(&executor));
+    executor_destroy(&executor);
+}
+
+TEST(executor, every_instance_is_ticked_once_per_tick)
+{
+    uint32_t i;
+
+    add_task_to_all_nodes(every_tick_task);
+    CHECK_TRUE(executor_init(&executor, instances, NO_OF_NODES, 4));
+    executor_run(&executor, 10);
+    executor_run(&executor, 5);
+    LONGS_EQUAL(15, executor_get_ticks(&executor));
+    executor_destroy(&executor);
+
+    for (i = 0; i < NO_OF_NODES; i++)
+    {
+        LONGS_EQUAL(15, nodes[i].runs);
+        LONGS_EQUAL(0, nodes[i].tick_errors);
+        LONGS_EQUAL(15, scheduler_get_task_runs(&nodes[i].scheduler, 0));
+    }
+}
+
+TEST(executor, single_thread)
+{
+    uint32_t i;
+
+    add_task_to_all_nodes(every_tick_task);
+    CHECK_TRUE(executor_init(&executor, instances, NO_OF_NODES, 1));
+    executor_run(&executor, 3);
+    executor_destroy(&executor);
+
+    for (i = 0; i < NO_OF_NODES; i++)
+    {
+        LONGS_EQUAL(3, nodes[i].runs);
+        LONGS_EQUAL(0, nodes[i].tick_errors);
+    }
+    LONGS_EQUAL(0, executor_get_steals(&executor));
+}
+
+TEST(executor, more_threads_than_instances)
+{
+    add_task_to_all_nodes(every_tick_task);
+    CHECK_TRUE(executor_init(&executor, instances, 2, EXECUTOR_MAX_THREADS));
+    executor_run(&executor, 4);
+    executor_destroy(&executor);
+
+    LONGS_EQUAL(4, nodes[0].runs);
+    LONGS_EQUAL(4, nodes[1].runs);
+    LONGS_EQUAL(0, nodes[2].runs);
+}
+
+/*
+ * Node i runs a task with period (i % 4) + 1, i.e., the instances keep their
+ * own schedules on the shared clock.
+ */
+TEST(executor, instances_keep_their_periods)
+{
+    uint32_t i;
+
+    for (i = 0; i < NO_OF_NODES; i++)
+    {
+        scheduler_add_task(&nodes[i].scheduler, (uint8_t)((i % 4) + 1), 0, count_task);
+    }
+    CHECK_TRUE(executor_init(&executor, instances, NO_OF_NODES, 3));
+    executor_run(&executor, 24);
+    executor_destroy(&executor);
+
+    for (i = 0; i < NO_OF_NODES; i++)
+    {
+        LONGS_EQUAL(24 / ((i % 4) + 1), nodes[i].runs);
+        LONGS_EQUAL(24, nodes[i].last_tick);
+    }
+}
+
+/*
+ * The first half of the instances is slow.  The thread that owns the second
+ * half will steal instances from the first half.
+ */
+TEST(executor, idle_thread_steals_instances)
+{
+    uint32_t i;
+
+    for (i = 0; i < 16; i++)
+    {
+        scheduler_add_task(&nodes[i].scheduler, 1, 0, (i < 8) ? slow_task : count_task);
+    }
+    CHECK_TRUE(executor_init(&executor, instances, 16, 2));
+    executor_run(&executor, 1);
+    executor_destroy(&executor);
+
+    CHECK(executor_get_steals(&executor) > 0);
+    for (i = 0; i < 16; i++)
+    {
+        LONGS_EQUAL(1, nodes[i].runs);
+    }
+}
+
+TEST(executor, no_current_instance_outside_tick)
+{
+    POINTERS_EQUAL(NULL, executor_current_instance());
+    add_task_to_all_nodes(count_task);
+    CHECK_TRUE(executor_init(&executor, instances, NO_OF_NODES, 2));
+    executor_run(&executor, 1);
+    executor_destroy(&executor);
+    POINTERS_EQUAL(NULL, executor_current_instance());
+}
+
+
+/********************************************************************
+ * TEST RUNNER
+ ********************************************************************/
+int main(int ac, char** av)
+{
+    return CommandLineTestRunner::RunAllTests(ac, av);
+}
@@ -5,7 +5,7 @@
  *
  * The implementation uses the CppUMock framework
  *
- * Copyright (c) 2020. BlueZephyr
+ * Copyright (c) 2020-2021. BlueZephyr
  *
  * This software may be modified and distributed under the terms
  * of the MIT license.  See the LICENSE file for details.
@@ -18,13 +18,18 @@ extern "C"
 {
     // This module mocks the following interface
     #include "hal/timer.h"
+    #include "timer_mock.h"
 }
 
 static Tick_t tick;
+static uint8_t polls;
+static uint16_t subticks;
 
 void timer_init(void)
 {
     tick = 0;
+    polls = 0;
+    subticks = 0;
 }
 
 void timer_start(void)
@@ -34,6 +39,25 @@ void timer_start(void)
 
 Tick_t timer_get_ticks(void)
 {
-    return tick++;
+    if (polls++ & 1)
+    {
+        tick++;
+    }
+    return tick;
+}
+
+uint16_t timer_get_subticks(void)
+{
+    return subticks;
+}
+
+void timer_mock_advance_ticks(Tick_t ticks)
+{
+    tick += ticks;
+}
+
+void timer_mock_set_subticks(uint16_t value)
+{
+    subticks = value;
 }
 
@@ -0,0 +1,30 @@
+/*
+ * Control functions for the mock timer used in the unit tests.
+ *
+ * The mock timer advances the tick every second time the ticks are read.  The
+ * scheduler will hence process exactly one new tick in each call to
+ * schedule_run and the tick will not change while the tasks are running.
+ *
+ * Copyright (c) 2021 BlueZephyr
+ *
+ * This software may be modified and distributed under the terms
+ * of the MIT license.  See the LICENSE file for details.
+ *
+ */
+
+#ifndef BL_TIMER_MOCK_H
+#define BL_TIMER_MOCK_H
+
+#include "hal/timer.h"
+
+/*
+ * Advance the tick immediately, e.g., from a task to simulate an overrun.
+ */
+void timer_mock_advance_ticks(Tick_t ticks);
+
+/*
+ * Set the value returned by timer_get_subticks.
+ */
+void timer_mock_set_subticks(uint16_t subticks);
+
+#endif // BL_TIMER_MOCK_H
@@ -0,0 +1,115 @@
+/*
+ * Implementation of the UART HAL and digital IO pin mock for the unit tests.
+ *
+ * Copyright (c) 2021. BlueZephyr
+ *
+ * This software may be modified and distributed under the terms
+ * of the MIT license.  See the LICENSE file for details.
+ *
+ */
+
+extern "C"
+{
+    // This module mocks the following interfaces
+    #include "hal/uart_hal.h"
+    #include "hal/pin_digital_io.h"
+    #include "uart_hal_mock.h"
+}
+
+#define PIN_MOCK_NO_OF_PINS     16
+
+typedef struct
+{
+    bytebuffer_t *outBuffer;
+    uint16_t sends;
+    uint16_t no_of_immediate;
+    uint8_t last_immediate;
+} UartHalMock_t;
+
+static UartHalMock_t ports[UART_NO_PORTS];
+static bool pins[PIN_MOCK_NO_OF_PINS];
+
+void uart_hal_mock_init(void)
+{
+    uint16_t i;
+
+    for (i = 0; i < UART_NO_PORTS; i++)
+    {
+        ports[i].outBuffer = nullptr;
+        ports[i].sends = 0;
+        ports[i].no_of_immediate = 0;
+        ports[i].last_immediate = 0;
+    }
+    for (i = 0; i < PIN_MOCK_NO_OF_PINS; i++)
+    {
+        pins[i] = false;
+    }
+}
+
+uint16_t uart_hal_mock_get_sends(enum uart_port_t port)
+{
+    return ports[port].sends;
+}
+
+uint16_t uart_hal_mock_get_no_of_immediate(enum uart_port_t port)
+{
+    return ports[port].no_of_immediate;
+}
+
+uint8_t uart_hal_mock_get_last_immediate(enum uart_port_t port)
+{
+    return ports[port].last_immediate;
+}
+
+uint16_t uart_hal_mock_transmit(enum uart_port_t port, uint16_t nbytes)
+{
+    uint16_t i;
+
+    for (i = 0; (i < nbytes) && !bytebuffer_isEmpty(ports[port].outBuffer) &&
+                uart_transmit_allowed(port); i++)
+    {
+        bytebuffer_read(ports[port].outBuffer);
+    }
+    return i;
+}
+
+void uart_hal_init(enum uart_port_t port, bytebuffer_t *outBuffer)
+{
+    ports[port].outBuffer = outBuffer;
+}
+
+void uart_hal_send(enum uart_port_t port)
+{
+    ports[port].sends++;
+}
+
+void uart_hal_send_immediate(enum uart_port_t port, uint8_t byte)
+{
+    ports[port].no_of_immediate++;
+    ports[port].last_immediate = byte;
+}
+
+void pin_digital_io_mock_set(uint16_t pin_id, bool high)
+{
+    pins[pin_id] = high;
+}
+
+bool pin_digital_io_mock_get(uint16_t pin_id)
+{
+    return pins[pin_id];
+}
+
+bool pin_digital_io_read(uint16_t pin_id)
+{
+    return pins[pin_id];
+}
+
+void pin_digital_io_write_high(uint16_t pin_id)
+{
+    pins[pin_id] = true;
+}
+
+void pin_digital_io_write_low(uint16_t pin_id)
+{
+    pins[pin_id] = false;
+}
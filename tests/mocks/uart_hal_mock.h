@@ -0,0 +1,47 @@
+/*
+ * Mock of the UART HAL and the digital IO pins for the unit tests of the UART
+ * driver.  The mock records the calls from the driver and can transmit the
+ * bytes of the out buffer like the transmit interrupt of a real HAL.
+ *
+ * Copyright (c) 2021 BlueZephyr
+ *
+ * This software may be modified and distributed under the terms
+ * of the MIT license.  See the LICENSE file for details.
+ *
+ */
+
+#ifndef BL_UART_HAL_MOCK_H
+#define BL_UART_HAL_MOCK_H
+
+#include "hal/uart_hal.h"
+
+/*
+ * Clear the recorded calls and set all pins low.
+ */
+void uart_hal_mock_init(void);
+
+/*
+ * Get the number of calls to uart_hal_send for the port.
+ */
+uint16_t uart_hal_mock_get_sends(enum uart_port_t port);
+
+/*
+ * Get the number of bytes sent with uart_hal_send_immediate for the port and
+ * the last of them.
+ */
+uint16_t uart_hal_mock_get_no_of_immediate(enum uart_port_t port);
+uint8_t uart_hal_mock_get_last_immediate(enum uart_port_t port);
+
+/*
+ * Take up to nbytes from the out buffer of the port while the driver allows
+ * the transmission.  Returns the number of transmitted bytes.
+ */
+uint16_t uart_hal_mock_transmit(enum uart_port_t port, uint16_t nbytes);
+
+/*
+ * Set and get the level of a digital IO pin.
+ */
+void pin_digital_io_mock_set(uint16_t pin_id, bool high);
+bool pin_digital_io_mock_get(uint16_t pin_id);
+
+#endif // BL_UART_HAL_MOCK_H
@@ -0,0 +1,84 @@
+/*
+ * Implementation of the UART driver mock for the unit tests.
+ *
+ * Copyright (c) 2021. BlueZephyr
+ *
+ * This software may be modified and distributed under the terms
+ * of the MIT license.  See the LICENSE file for details.
+ *
+ */
+
+extern "C"
+{
+    // This module mocks the following interface
+    #include "core/uart.h"
+    #include "uart_mock.h"
+}
+
+#define UART_MOCK_CAPTURE_SIZE  1024
+
+static uint8_t written[UART_MOCK_CAPTURE_SIZE];
+static uint16_t no_of_written;
+static uint16_t space;
+static enum uart_port_t last_port;
+
+void uart_mock_init(void)
+{
+    no_of_written = 0;
+    space = UART_MOCK_CAPTURE_SIZE;
+}
+
+void uart_mock_set_space(uint16_t value)
+{
+    space = value;
+}
+
+uint16_t uart_mock_get_no_of_written(void)
+{
+    return no_of_written;
+}
+
+const uint8_t *uart_mock_get_written(void)
+{
+    return written;
+}
+
+enum uart_port_t uart_mock_get_port(void)
+{
+    return last_port;
+}
+
+void uart_init(enum uart_port_t port)
+{
+    (void)port;
+}
+
+uint16_t uart_read(enum uart_port_t port, uint8_t* buffer, uint16_t nbytes)
+{
+    (void)port;
+    (void)buffer;
+    (void)nbytes;
+    return 0;
+}
+
+uint16_t uart_write(enum uart_port_t port, uint8_t* buffer, uint16_t nbytes)
+{
+    uint16_t i;
+
+    last_port = port;
+
+    if (nbytes > space)
+    {
+        nbytes = space;
+    }
+    if (nbytes > UART_MOCK_CAPTURE_SIZE - no_of_written)
+    {
+        nbytes = UART_MOCK_CAPTURE_SIZE - no_of_written;
+    }
+
+    for (i = 0; i < nbytes; i++)
+    {
+        written[no_of_written++] = buffer[i];
+    }
+    return nbytes;
+}
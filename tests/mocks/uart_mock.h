@@ -0,0 +1,35 @@
+/*
+ * Mock of the UART driver for the unit tests.  The bytes written to any port
+ * are captured and the space in the send buffer can be controlled by the test
+ * cases.
+ *
+ * Copyright (c) 2021 BlueZephyr
+ *
+ * This software may be modified and distributed under the terms
+ * of the MIT license.  See the LICENSE file for details.
+ *
+ */
+
+#ifndef BL_UART_MOCK_H
+#define BL_UART_MOCK_H
+
+#include "core/uart.h"
+
+/*
+ * Clear the captured bytes and let the send buffer have unlimited space.
+ */
+void uart_mock_init(void);
+
+/*
+ * Set the number of bytes that uart_write accepts in the following calls.
+ */
+void uart_mock_set_space(uint16_t space);
+
+/*
+ * Get the captured bytes and the port of the last write.
+ */
+uint16_t uart_mock_get_no_of_written(void);
+const uint8_t *uart_mock_get_written(void);
+enum uart_port_t uart_mock_get_port(void);
+
+#endif // BL_UART_MOCK_H
@@ -0,0 +1,158 @@
+/*
+ * Unit tests for the Bit Loom message queues.
+ *
+ * Copyright (c) 2021. BlueZephyr
+ *
+ * This software may be modified and distributed under the terms
+ * of the MIT license.  See the LICENSE file for details.
+ *
+ */
+
+#include "CppUTest/CommandLineTestRunner.h"
+#include "CppUTestExt/MockSupport.h"
+
+extern "C"
+{
+    #include "core/msgqueue.h"
+    #include "core/scheduler.h"
+    #include "mocks/spy_task.h"
+    #include "hal/timer.h"
+}
+
+#define NO_OF_BLOCKS    4
+
+typedef struct
+{
+    uint16_t id;
+    uint8_t data[6];
+} Message_t;
+
+TEST_GROUP(msgqueue)
+{
+    msgqueue_t queue;
+    Message_t blocks[NO_OF_BLOCKS];
+    void *rings[MSGQUEUE_RINGS_SIZE(NO_OF_BLOCKS)];
+
+    void setup() override
+    {
+        msgqueue_init(&queue, blocks, sizeof(Message_t), NO_OF_BLOCKS, rings);
+    }
+
+    void teardown() override
+    {
+        mock().checkExpectations();
+        mock().clear();
+    }
+
+    void post_message(uint16_t id)
+    {
+        Message_t *message = (Message_t *)msgqueue_alloc(&queue);
+        CHECK(message != NULL);
+        message->id = id;
+        msgqueue_post(&queue, message);
+    }
+
+    void receive_message(uint16_t id)
+    {
+        Message_t *message = (Message_t *)msgqueue_receive(&queue);
+        CHECK(message != NULL);
+        LONGS_EQUAL(id, message->id);
+        msgqueue_release(&queue, message);
+    }
+};
+
+
+/*
+ * TEST CASES
+ */
+TEST(msgqueue, empty_queue_returns_null)
+{
+    POINTERS_EQUAL(NULL, msgqueue_receive(&queue));
+}
+
+TEST(msgqueue, alloc_all_blocks)
+{
+    uint8_t i;
+    void *block;
+
+    for (i = 0; i < NO_OF_BLOCKS; i++)
+    {
+        block = msgqueue_alloc(&queue);
+        POINTERS_EQUAL(&blocks[i], block);
+    }
+    POINTERS_EQUAL(NULL, msgqueue_alloc(&queue));
+}
+
+TEST(msgqueue, posted_block_is_received)
+{
+    void *block = msgqueue_alloc(&queue);
+    msgqueue_post(&queue, block);
+    POINTERS_EQUAL(block, msgqueue_receive(&queue));
+    POINTERS_EQUAL(NULL, msgqueue_receive(&queue));
+}
+
+TEST(msgqueue, messages_are_received_in_order)
+{
+    post_message(1);
+    post_message(2);
+    post_message(3);
+    receive_message(1);
+    receive_message(2);
+    receive_message(3);
+}
+
+TEST(msgqueue, released_block_can_be_allocated)
+{
+    uint8_t i;
+
+    for (i = 0; i < NO_OF_BLOCKS; i++)
+    {
+        post_message(i);
+    }
+    POINTERS_EQUAL(NULL, msgqueue_alloc(&queue));
+    receive_message(0);
+    CHECK(msgqueue_alloc(&queue) != NULL);
+}
+
+TEST(msgqueue, queue_wraps_around)
+{
+    uint16_t i;
+
+    for (i = 0; i < 1000; i++)
+    {
+        post_message(i);
+        post_message(i + 1);
+        receive_message(i);
+        receive_message(i + 1);
+    }
+    POINTERS_EQUAL(NULL, msgqueue_receive(&queue));
+}
+
+TEST(msgqueue, post_wakes_event_task)
+{
+    mock().ignoreOtherCalls();
+    timer_init();
+    schedule_init();
+    SpyTask_t task = spytask_create_counter_task(0, 0);
+    msgqueue_set_wake_task(&queue, schedule_add_event_task(task.run));
+
+    schedule_start();
+    schedule_run();
+    LONGS_EQUAL(0, spytask_get_no_of_runs());
+
+    post_message(1);
+    post_message(2);
+    schedule_run();
+    LONGS_EQUAL(1, spytask_get_no_of_runs());
+    schedule_run();
+    LONGS_EQUAL(1, spytask_get_no_of_runs());
+}
+
+
+/********************************************************************
+ * TEST RUNNER
+ ********************************************************************/
+int main(int ac, char** av)
+{
+    return CommandLineTestRunner::RunAllTests(ac, av);
+}
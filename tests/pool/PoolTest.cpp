@@ -0,0 +1,176 @@
+/*
+ * Unit tests for the Bit Loom memory pools.
+ *
+ * Copyright (c) 2021. BlueZephyr
+ *
+ * This software may be modified and distributed under the terms
+ * of the MIT license.  See the LICENSE file for details.
+ *
+ */
+
+#include "CppUTest/CommandLineTestRunner.h"
+
+extern "C"
+{
+    #include "core/pool.h"
+}
+
+TEST_GROUP(pool)
+{
+    pool_stats_t stats;
+
+    void setup() override
+    {
+        pool_init();
+    }
+
+    void alloc_blocks(enum pool_id_t pool, void **blocks, uint8_t no_of_blocks)
+    {
+        uint8_t i;
+
+        for (i = 0; i < no_of_blocks; i++)
+        {
+            blocks[i] = pool_alloc(pool);
+            CHECK(blocks[i] != NULL);
+        }
+    }
+};
+
+
+/*
+ * TEST CASES
+ */
+TEST(pool, stats_after_init)
+{
+    CHECK_TRUE(pool_get_stats(POOL_SMALL, &stats));
+    LONGS_EQUAL(3, stats.block_size);
+    LONGS_EQUAL(4, stats.no_of_blocks);
+    LONGS_EQUAL(0, stats.in_use);
+    LONGS_EQUAL(0, stats.high_water);
+    LONGS_EQUAL(0, stats.failures);
+}
+
+TEST(pool, invalid_pool)
+{
+    POINTERS_EQUAL(NULL, pool_alloc(POOL_NO_POOLS));
+    CHECK_FALSE(pool_get_stats(POOL_NO_POOLS, &stats));
+}
+
+TEST(pool, alloc_distinct_aligned_blocks)
+{
+    void *blocks[4];
+    uint8_t i;
+
+    alloc_blocks(POOL_SMALL, blocks, 4);
+    for (i = 1; i < 4; i++)
+    {
+        CHECK(blocks[i] != blocks[i - 1]);
+        LONGS_EQUAL(0, (uintptr_t)blocks[i] % sizeof(void *));
+    }
+}
+
+TEST(pool, exhausted_pool_returns_null_and_counts_failure)
+{
+    void *blocks[2];
+
+    alloc_blocks(POOL_LARGE, blocks, 2);
+    POINTERS_EQUAL(NULL, pool_alloc(POOL_LARGE));
+    POINTERS_EQUAL(NULL, pool_alloc(POOL_LARGE));
+    pool_get_stats(POOL_LARGE, &stats);
+    LONGS_EQUAL(2, stats.in_use);
+    LONGS_EQUAL(2, stats.failures);
+}
+
+TEST(pool, pools_are_independent)
+{
+    void *blocks[2];
+
+    alloc_blocks(POOL_LARGE, blocks, 2);
+    CHECK(pool_alloc(POOL_SMALL) != NULL);
+}
+
+TEST(pool, freed_block_is_reused)
+{
+    void *block = pool_alloc(POOL_SMALL);
+    pool_free(POOL_SMALL, block);
+    POINTERS_EQUAL(block, pool_alloc(POOL_SMALL));
+}
+
+TEST(pool, free_to_wrong_pool_is_rejected)
+{
+    void *block = pool_alloc(POOL_LARGE);
+    pool_alloc(POOL_SMALL);
+    CHECK_FALSE(pool_free(POOL_SMALL, block));
+    pool_get_stats(POOL_SMALL, &stats);
+    LONGS_EQUAL(1, stats.in_use);
+    CHECK(pool_alloc(POOL_SMALL) != block);
+    CHECK_TRUE(pool_free(POOL_LARGE, block));
+}
+
+TEST(pool, free_of_unaligned_block_is_rejected)
+{
+    uint8_t *block = (uint8_t *)pool_alloc(POOL_LARGE);
+    CHECK_FALSE(pool_free(POOL_LARGE, block + 4));
+    pool_get_stats(POOL_LARGE, &stats);
+    LONGS_EQUAL(1, stats.in_use);
+}
+
+TEST(pool, double_free_does_not_wrap_in_use)
+{
+    void *block = pool_alloc(POOL_SMALL);
+    CHECK_TRUE(pool_free(POOL_SMALL, block));
+    CHECK_FALSE(pool_free(POOL_SMALL, block));
+    pool_get_stats(POOL_SMALL, &stats);
+    LONGS_EQUAL(0, stats.in_use);
+}
+
+TEST(pool, high_water_mark)
+{
+    void *blocks[4];
+
+    alloc_blocks(POOL_SMALL, blocks, 3);
+    pool_free(POOL_SMALL, blocks[0]);
+    pool_free(POOL_SMALL, blocks[1]);
+    pool_get_stats(POOL_SMALL, &stats);
+    LONGS_EQUAL(1, stats.in_use);
+    LONGS_EQUAL(3, stats.high_water);
+}
+
+TEST(pool, reset_stats)
+{
+    void *blocks[2];
+
+    alloc_blocks(POOL_LARGE, blocks, 2);
+    pool_alloc(POOL_LARGE);
+    pool_free(POOL_LARGE, blocks[0]);
+    pool_reset_stats(POOL_LARGE);
+    pool_get_stats(POOL_LARGE, &stats);
+    LONGS_EQUAL(1, stats.in_use);
+    LONGS_EQUAL(1, stats.high_water);
+    LONGS_EQUAL(0, stats.failures);
+}
+
+TEST(pool, block_data_is_usable)
+{
+    uint8_t *block = (uint8_t *)pool_alloc(POOL_LARGE);
+    uint8_t i;
+
+    for (i = 0; i < 64; i++)
+    {
+        block[i] = i;
+    }
+    CHECK(pool_alloc(POOL_LARGE) != NULL);
+    for (i = 0; i < 64; i++)
+    {
+        LONGS_EQUAL(i, block[i]);
+    }
+}
+
+
+/********************************************************************
+ * TEST RUNNER
+ ********************************************************************/
+int main(int ac, char** av)
+{
+    return CommandLineTestRunner::RunAllTests(ac, av);
+}
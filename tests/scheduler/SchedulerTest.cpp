@@ -16,6 +16,12 @@ extern "C"
     #include "core/scheduler.h"
     #include "mocks/spy_task.h"
     #include "hal/timer.h"
+    #include "mocks/timer_mock.h"
+}
+
+static void overrun_function (void)
+{
+    timer_mock_advance_ticks(1);
 }
 
 /*
@@ -135,6 +141,429 @@ TEST(scheduler, schedule_one_task_scheduled_many_offset_one)
     LONGS_EQUAL(2, spytask_get_no_of_runs());
 }
 
+/*
+ * [ - R - R - R ] - period 2, offset auto -> 0
+ * [ - - R - R - ] - period 2, offset auto -> 1
+ */
+TEST(scheduler, auto_offset_avoids_busy_tick)
+{
+    mock().ignoreOtherCalls();
+    SpyTask_t task = spytask_create_counter_task(2, SCHEDULE_OFFSET_AUTO);
+    schedule_add_task(task.period, task.offset, task.run);
+    schedule_add_task(task.period, task.offset, task.run);
+    start_tick_run(2);
+    LONGS_EQUAL(1, spytask_get_no_of_runs());
+    start_tick_run(1);
+    LONGS_EQUAL(2, spytask_get_no_of_runs());
+}
+
+TEST(scheduler, auto_offset_with_period_one)
+{
+    mock().ignoreOtherCalls();
+    SpyTask_t task = spytask_create_counter_task(1, SCHEDULE_OFFSET_AUTO);
+    schedule_add_task(task.period, task.offset, task.run);
+    start_tick_run(1);
+    LONGS_EQUAL(1, spytask_get_no_of_runs());
+}
+
+/*
+ * [ - - - - R - - - R ] - period 4, offset 0, cost 3
+ * [ - - - - - R - - - ] - period 4, offset 1, cost 1
+ * [ - - - R - R - R - ] - period 2, offset auto -> 1 (shares ticks with the
+ *                         cheaper task)
+ */
+TEST(scheduler, auto_offset_uses_task_cost)
+{
+    mock().ignoreOtherCalls();
+    SpyTask_t task = spytask_create_counter_task(4, 0);
+    schedule_set_task_cost(schedule_add_task(task.period, 0, task.run), 3);
+    schedule_add_task(task.period, 1, task.run);
+    schedule_add_task(2, SCHEDULE_OFFSET_AUTO, task.run);
+    start_tick_run(2);
+    LONGS_EQUAL(0, spytask_get_no_of_runs());
+    start_tick_run(1);
+    LONGS_EQUAL(1, spytask_get_no_of_runs());
+}
+
+TEST(scheduler, long_period_with_large_offset)
+{
+    mock().ignoreOtherCalls();
+    SpyTask_t task = spytask_create_counter_task(250, 10);
+    schedule_add_task(task.period, task.offset, task.run);
+    start_tick_run(259);
+    LONGS_EQUAL(0, spytask_get_no_of_runs());
+    start_tick_run(1);
+    LONGS_EQUAL(1, spytask_get_no_of_runs());
+    start_tick_run(250);
+    LONGS_EQUAL(2, spytask_get_no_of_runs());
+}
+
+/*
+ * Seven tasks with period 250 and offsets 0-6.  The first free offset is 7.
+ */
+TEST(scheduler, auto_offset_with_long_period)
+{
+    mock().ignoreOtherCalls();
+    uint8_t offset;
+    uint8_t taskid;
+
+    for (offset = 0; offset < 7; offset++)
+    {
+        schedule_add_task(250, offset, nullptr);
+    }
+    SpyTask_t task = spytask_create_counter_task(250, SCHEDULE_OFFSET_AUTO);
+    taskid = schedule_add_task(task.period, task.offset, task.run);
+    // The first tasks have no run function
+    for (offset = 0; offset < 7; offset++)
+    {
+        schedule_suspend(offset);
+    }
+    start_tick_run(256);
+    LONGS_EQUAL(0, schedule_get_task_runs(taskid));
+    start_tick_run(1);
+    LONGS_EQUAL(1, schedule_get_task_runs(taskid));
+}
+
+TEST(scheduler, event_task_not_run_without_trigger)
+{
+    mock().ignoreOtherCalls();
+    SpyTask_t task = spytask_create_counter_task(0, 0);
+    schedule_add_event_task(task.run);
+    start_tick_run(10);
+    LONGS_EQUAL(0, spytask_get_no_of_runs());
+}
+
+TEST(scheduler, triggered_event_task_runs_once)
+{
+    mock().ignoreOtherCalls();
+    SpyTask_t task = spytask_create_counter_task(0, 0);
+    uint8_t taskid = schedule_add_event_task(task.run);
+    schedule_trigger_task(taskid);
+    schedule_trigger_task(taskid);
+    start_tick_run(3);
+    LONGS_EQUAL(1, spytask_get_no_of_runs());
+    schedule_trigger_task(taskid);
+    start_tick_run(1);
+    LONGS_EQUAL(2, spytask_get_no_of_runs());
+}
+
+/*
+ * [ - - - - R - R - R ] - period 4 -> 2 after the first run
+ */
+TEST(scheduler, set_period_keeps_next_release)
+{
+    mock().ignoreOtherCalls();
+    SpyTask_t task = spytask_create_counter_task(4, 0);
+    uint8_t taskid = schedule_add_task(task.period, task.offset, task.run);
+    start_tick_run(4);
+    LONGS_EQUAL(1, spytask_get_no_of_runs());
+    schedule_set_period(taskid, 2);
+    start_tick_run(1);
+    LONGS_EQUAL(1, spytask_get_no_of_runs());
+    start_tick_run(3);
+    LONGS_EQUAL(3, spytask_get_no_of_runs());
+}
+
+/*
+ * [ - - - - - - - R ] - period 8
+ * [ - - R - R - R - ] - period 8 -> 2 after one tick, keeps the phase
+ */
+TEST(scheduler, shorter_period_moves_next_release_forward)
+{
+    mock().ignoreOtherCalls();
+    SpyTask_t task = spytask_create_counter_task(8, 0);
+    uint8_t taskid = schedule_add_task(task.period, task.offset, task.run);
+    start_tick_run(1);
+    schedule_set_period(taskid, 2);
+    start_tick_run(1);
+    LONGS_EQUAL(1, spytask_get_no_of_runs());
+    start_tick_run(2);
+    LONGS_EQUAL(2, spytask_get_no_of_runs());
+}
+
+TEST(scheduler, period_of_event_task_cannot_be_set)
+{
+    mock().ignoreOtherCalls();
+    SpyTask_t task = spytask_create_counter_task(0, 0);
+    uint8_t taskid = schedule_add_event_task(task.run);
+    schedule_set_period(taskid, 1);
+    start_tick_run(3);
+    LONGS_EQUAL(0, spytask_get_no_of_runs());
+}
+
+/*
+ * [ - S - S - R - R ] - period 2, suspended for the first four ticks
+ */
+TEST(scheduler, suspended_task_keeps_phase)
+{
+    mock().ignoreOtherCalls();
+    SpyTask_t task = spytask_create_counter_task(2, 0);
+    uint8_t taskid = schedule_add_task(task.period, task.offset, task.run);
+    schedule_suspend(taskid);
+    start_tick_run(5);
+    LONGS_EQUAL(0, spytask_get_no_of_runs());
+    LONGS_EQUAL(0, schedule_get_task_runs(taskid));
+    schedule_resume(taskid);
+    start_tick_run(1);
+    LONGS_EQUAL(1, spytask_get_no_of_runs());
+    start_tick_run(2);
+    LONGS_EQUAL(2, spytask_get_no_of_runs());
+}
+
+TEST(scheduler, trigger_of_suspended_event_task_is_kept)
+{
+    mock().ignoreOtherCalls();
+    SpyTask_t task = spytask_create_counter_task(0, 0);
+    uint8_t taskid = schedule_add_event_task(task.run);
+    schedule_suspend(taskid);
+    schedule_trigger_task(taskid);
+    start_tick_run(3);
+    LONGS_EQUAL(0, spytask_get_no_of_runs());
+    schedule_resume(taskid);
+    start_tick_run(1);
+    LONGS_EQUAL(1, spytask_get_no_of_runs());
+}
+
+TEST(scheduler, removed_task_is_not_run)
+{
+    mock().ignoreOtherCalls();
+    SpyTask_t task = spytask_create_counter_task(1, 0);
+    uint8_t taskid = schedule_add_task(task.period, task.offset, task.run);
+    schedule_add_task(task.period, task.offset, task.run);
+    start_tick_run(1);
+    LONGS_EQUAL(2, spytask_get_no_of_runs());
+    schedule_remove_task(taskid);
+    start_tick_run(1);
+    LONGS_EQUAL(3, spytask_get_no_of_runs());
+}
+
+TEST(scheduler, slot_of_removed_task_is_reused)
+{
+    add_no_of_tasks(3);
+    schedule_remove_task(0);
+    UNSIGNED_LONGS_EQUAL(0, schedule_add_task(1, 1, nullptr));
+    schedule_remove_task(2);
+    schedule_remove_task(1);
+    UNSIGNED_LONGS_EQUAL(1, schedule_add_task(1, 1, nullptr));
+    UNSIGNED_LONGS_EQUAL(2, schedule_add_task(1, 1, nullptr));
+}
+
+TEST(scheduler, add_max_no_of_tasks_after_remove)
+{
+    add_no_of_tasks(SCHEDULER_NO_TASKS);
+    schedule_remove_task(5);
+    UNSIGNED_LONGS_EQUAL(5, schedule_add_task(1, 1, nullptr));
+    UNSIGNED_LONGS_EQUAL(SCHEDULE_INVALID_TASK_ID, schedule_add_task(1, 1, nullptr));
+}
+
+/*
+ * [ - R - R - R ] - period 2, offset 0, removed
+ * [ - R - R - R ] - period 2, offset 0, removed
+ * [ - - R - R - ] - period 2, offset 1
+ * [ - R - R - R ] - period 2, offset auto -> 0
+ */
+TEST(scheduler, auto_offset_ignores_removed_tasks)
+{
+    mock().ignoreOtherCalls();
+    SpyTask_t task = spytask_create_counter_task(2, 0);
+    schedule_add_task(task.period, 0, task.run);
+    schedule_add_task(task.period, 0, task.run);
+    schedule_add_task(task.period, 1, task.run);
+    schedule_remove_task(0);
+    schedule_remove_task(1);
+    schedule_add_task(task.period, SCHEDULE_OFFSET_AUTO, task.run);
+    start_tick_run(2);
+    LONGS_EQUAL(1, spytask_get_no_of_runs());
+}
+
+TEST(scheduler, high_load_stretches_sheddable_tasks)
+{
+    mock().ignoreOtherCalls();
+    SpyTask_t task = spytask_create_counter_task(2, 0);
+    uint8_t sheddable = schedule_add_task(task.period, task.offset, task.run);
+    uint8_t critical = schedule_add_task(task.period, task.offset, task.run);
+    schedule_set_sheddable(sheddable, true);
+
+    // The average load reaches 80% in the sixth tick
+    timer_mock_set_subticks(TIMER_SUBTICKS_PER_TICK);
+    start_tick_run(5);
+    CHECK_FALSE(schedule_is_shedding());
+    start_tick_run(1);
+    CHECK_TRUE(schedule_is_shedding());
+    LONGS_EQUAL(3, schedule_get_task_runs(sheddable));
+    LONGS_EQUAL(3, schedule_get_task_runs(critical));
+
+    // The period is stretched from the next release
+    start_tick_run(10);
+    LONGS_EQUAL(5, schedule_get_task_runs(sheddable));
+    LONGS_EQUAL(8, schedule_get_task_runs(critical));
+}
+
+TEST(scheduler, low_load_restores_sheddable_tasks)
+{
+    mock().ignoreOtherCalls();
+    SpyTask_t task = spytask_create_counter_task(2, 0);
+    uint8_t sheddable = schedule_add_task(task.period, task.offset, task.run);
+    schedule_set_sheddable(sheddable, true);
+    timer_mock_set_subticks(TIMER_SUBTICKS_PER_TICK);
+    start_tick_run(8);
+    CHECK_TRUE(schedule_is_shedding());
+    LONGS_EQUAL(4, schedule_get_task_runs(sheddable));
+
+    // Hysteresis, shedding continues until the average load is 50%
+    timer_mock_set_subticks(TIMER_SUBTICKS_PER_TICK * 7 / 10);
+    start_tick_run(10);
+    CHECK_TRUE(schedule_is_shedding());
+    timer_mock_set_subticks(0);
+    start_tick_run(1);
+    CHECK_TRUE(schedule_is_shedding());
+    start_tick_run(1);
+    CHECK_FALSE(schedule_is_shedding());
+
+    // Restored in phase with the stretched period, i.e., on even ticks
+    LONGS_EQUAL(5, schedule_get_task_runs(sheddable));
+    start_tick_run(2);
+    LONGS_EQUAL(6, schedule_get_task_runs(sheddable));
+}
+
+TEST(scheduler, set_period_while_shedding_is_stretched)
+{
+    mock().ignoreOtherCalls();
+    SpyTask_t task = spytask_create_counter_task(2, 0);
+    uint8_t taskid = schedule_add_task(task.period, task.offset, task.run);
+    schedule_set_sheddable(taskid, true);
+    timer_mock_set_subticks(TIMER_SUBTICKS_PER_TICK);
+    start_tick_run(6);
+    CHECK_TRUE(schedule_is_shedding());
+    // Period 1 is stretched to 4 from the next release in tick 8
+    schedule_set_period(taskid, 1);
+    start_tick_run(2);
+    LONGS_EQUAL(4, schedule_get_task_runs(taskid));
+    start_tick_run(3);
+    LONGS_EQUAL(4, schedule_get_task_runs(taskid));
+    start_tick_run(1);
+    LONGS_EQUAL(5, schedule_get_task_runs(taskid));
+}
+
+TEST(scheduler, no_overrun_tasks)
+{
+    mock().ignoreOtherCalls();
+    SpyTask_t task = spytask_create_counter_task(1, 0);
+    schedule_add_task(task.period, task.offset, task.run);
+    start_tick_run(3);
+    UNSIGNED_LONGS_EQUAL(0, schedule_get_overrun_tasks());
+}
+
+/*
+ * [ - - O - - - O ] - period 4, offset 1, overruns
+ * [ - R - R - R - ] - period 2, offset 0
+ * [ R R R R R R R ] - period 1, offset 0
+ */
+TEST(scheduler, tasks_of_overrun_tick_are_marked)
+{
+    mock().ignoreOtherCalls();
+    SpyTask_t task = spytask_create_counter_task(1, 0);
+    SpyTask_t overrun = spytask_create_overrun_task(4, 1, overrun_function);
+    schedule_add_task(overrun.period, overrun.offset, overrun.run);
+    schedule_add_task(2, 0, task.run);
+    schedule_add_task(1, 0, task.run);
+    start_tick_run(4);
+    UNSIGNED_LONGS_EQUAL(0, schedule_get_overrun_tasks());
+    start_tick_run(1);
+    UNSIGNED_LONGS_EQUAL(0x5, schedule_get_overrun_tasks());
+    start_tick_run(2);
+    UNSIGNED_LONGS_EQUAL(0x5, schedule_get_overrun_tasks());
+}
+
+TEST(scheduler, load_of_idle_tick_is_zero)
+{
+    mock().ignoreOtherCalls();
+    start_tick_run(1);
+    LONGS_EQUAL(0, schedule_get_load());
+    LONGS_EQUAL(0, schedule_get_load_peak());
+}
+
+TEST(scheduler, load_is_busy_part_of_tick)
+{
+    mock().ignoreOtherCalls();
+    timer_mock_set_subticks(TIMER_SUBTICKS_PER_TICK / 2);
+    start_tick_run(1);
+    LONGS_EQUAL(50, schedule_get_load());
+    LONGS_EQUAL(50, schedule_get_load_peak());
+}
+
+TEST(scheduler, overrun_tick_is_full_load)
+{
+    mock().ignoreOtherCalls();
+    SpyTask_t task = spytask_create_overrun_task(2, 0, overrun_function);
+    schedule_add_task(task.period, task.offset, task.run);
+    start_tick_run(1);
+    LONGS_EQUAL(0, schedule_get_load());
+    start_tick_run(1);
+    LONGS_EQUAL(100, schedule_get_load());
+    start_tick_run(1);
+    LONGS_EQUAL(0, schedule_get_load());
+    LONGS_EQUAL(100, schedule_get_load_peak());
+}
+
+TEST(scheduler, load_average_follows_load)
+{
+    mock().ignoreOtherCalls();
+    timer_mock_set_subticks(TIMER_SUBTICKS_PER_TICK * 4 / 10);
+    start_tick_run(50);
+    LONGS_EQUAL(40, schedule_get_load_average());
+    timer_mock_set_subticks(0);
+    start_tick_run(1);
+    CHECK(schedule_get_load_average() < 40);
+    CHECK(schedule_get_load_average() > 0);
+}
+
+TEST(scheduler, load_histogram)
+{
+    mock().ignoreOtherCalls();
+    SpyTask_t task = spytask_create_overrun_task(6, 0, overrun_function);
+    schedule_add_task(task.period, task.offset, task.run);
+    start_tick_run(3);
+    timer_mock_set_subticks(TIMER_SUBTICKS_PER_TICK * 55 / 100);
+    start_tick_run(3);
+
+    const uint16_t *histogram = schedule_get_load_histogram();
+    LONGS_EQUAL(3, histogram[0]);
+    LONGS_EQUAL(2, histogram[5]);
+    LONGS_EQUAL(1, histogram[SCHEDULER_LOAD_HISTOGRAM_BINS - 1]);
+}
+
+TEST(scheduler, reset_load_statistics)
+{
+    mock().ignoreOtherCalls();
+    timer_mock_set_subticks(TIMER_SUBTICKS_PER_TICK);
+    start_tick_run(1);
+    schedule_reset_load_statistics();
+    LONGS_EQUAL(0, schedule_get_load_peak());
+    LONGS_EQUAL(0, schedule_get_load_histogram()[SCHEDULER_LOAD_HISTOGRAM_BINS - 1]);
+}
+
+
+TEST(scheduler, instances_are_independent)
+{
+    Scheduler_t first;
+    Scheduler_t second;
+    SpyTask_t task = spytask_create_counter_task(2, 0);
+
+    scheduler_init(&first);
+    scheduler_init(&second);
+    UNSIGNED_LONGS_EQUAL(0, scheduler_add_task(&first, task.period, task.offset, task.run));
+    UNSIGNED_LONGS_EQUAL(0, scheduler_add_task(&second, 1, 0, task.run));
+    UNSIGNED_LONGS_EQUAL(0, schedule_add_task(task.period, task.offset, task.run));
+
+    scheduler_tick(&first);
+    scheduler_tick(&first);
+    scheduler_tick(&second);
+    LONGS_EQUAL(1, scheduler_get_task_runs(&first, 0));
+    LONGS_EQUAL(1, scheduler_get_task_runs(&second, 0));
+    LONGS_EQUAL(0, schedule_get_task_runs(0));
+    LONGS_EQUAL(2, spytask_get_no_of_runs());
+}
 
 /********************************************************************
  * TEST RUNNER
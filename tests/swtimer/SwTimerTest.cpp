@@ -0,0 +1,225 @@
+/*
+ * Unit tests for the Bit Loom software timers.
+ *
+ * Copyright (c) 2021. BlueZephyr
+ *
+ * This software may be modified and distributed under the terms
+ * of the MIT license.  See the LICENSE file for details.
+ *
+ */
+
+#include "CppUTest/CommandLineTestRunner.h"
+
+extern "C"
+{
+    #include "core/swtimer.h"
+}
+
+typedef struct
+{
+    uint32_t no_of_expiries;
+    uint32_t expired_at;
+    swtimer_t *target;      // Timer to cancel or restart from the callback
+} TimerSpy_t;
+
+static uint32_t ticks;
+
+static void spy_callback (void *context)
+{
+    TimerSpy_t *spy = (TimerSpy_t *)context;
+    spy->no_of_expiries++;
+    spy->expired_at = ticks;
+}
+
+static void cancel_callback (void *context)
+{
+    spy_callback(context);
+    swtimer_cancel(((TimerSpy_t *)context)->target);
+}
+
+static void restart_callback (void *context)
+{
+    spy_callback(context);
+    if (((TimerSpy_t *)context)->no_of_expiries < 3)
+    {
+        swtimer_restart(((TimerSpy_t *)context)->target);
+    }
+}
+
+TEST_GROUP(swtimer)
+{
+    swtimer_t timer;
+    TimerSpy_t spy;
+
+    void setup() override
+    {
+        ticks = 0;
+        swtimer_init();
+        spy.no_of_expiries = 0;
+        spy.expired_at = 0;
+        spy.target = &timer;
+        swtimer_setup(&timer, spy_callback, &spy);
+    }
+
+    void tick(uint32_t no_of_ticks)
+    {
+        uint32_t i;
+
+        for (i = 0; i < no_of_ticks; i++)
+        {
+            ticks++;
+            swtimer_tick();
+        }
+    }
+};
+
+
+/*
+ * TEST CASES
+ */
+TEST(swtimer, timer_not_active_after_setup)
+{
+    CHECK_FALSE(swtimer_is_active(&timer));
+}
+
+TEST(swtimer, one_shot_timer_expires_after_delay)
+{
+    swtimer_start(&timer, 5, 0);
+    CHECK_TRUE(swtimer_is_active(&timer));
+    tick(4);
+    LONGS_EQUAL(0, spy.no_of_expiries);
+    tick(1);
+    LONGS_EQUAL(1, spy.no_of_expiries);
+    CHECK_FALSE(swtimer_is_active(&timer));
+    tick(100);
+    LONGS_EQUAL(1, spy.no_of_expiries);
+}
+
+TEST(swtimer, zero_delay_expires_next_tick)
+{
+    swtimer_start(&timer, 0, 0);
+    tick(1);
+    LONGS_EQUAL(1, spy.no_of_expiries);
+}
+
+TEST(swtimer, periodic_timer_expires_every_period)
+{
+    swtimer_start(&timer, 3, 7);
+    tick(3);
+    LONGS_EQUAL(1, spy.no_of_expiries);
+    tick(70);
+    LONGS_EQUAL(11, spy.no_of_expiries);
+    LONGS_EQUAL(73, spy.expired_at);
+    CHECK_TRUE(swtimer_is_active(&timer));
+}
+
+TEST(swtimer, cancelled_timer_does_not_expire)
+{
+    swtimer_start(&timer, 10, 0);
+    tick(5);
+    swtimer_cancel(&timer);
+    CHECK_FALSE(swtimer_is_active(&timer));
+    tick(10);
+    LONGS_EQUAL(0, spy.no_of_expiries);
+}
+
+TEST(swtimer, cancel_inactive_timer)
+{
+    swtimer_cancel(&timer);
+    CHECK_FALSE(swtimer_is_active(&timer));
+}
+
+TEST(swtimer, restart_extends_timeout)
+{
+    swtimer_start(&timer, 10, 0);
+    tick(8);
+    swtimer_restart(&timer);
+    tick(9);
+    LONGS_EQUAL(0, spy.no_of_expiries);
+    tick(1);
+    LONGS_EQUAL(1, spy.no_of_expiries);
+    LONGS_EQUAL(18, spy.expired_at);
+}
+
+TEST(swtimer, long_timers_expire_on_time)
+{
+    const uint32_t delays[] = {15, 16, 17, 255, 256, 257, 4095, 4097, 65539, 1048577};
+    const uint8_t no_of_timers = sizeof(delays) / sizeof(delays[0]);
+    swtimer_t timers[no_of_timers];
+    TimerSpy_t spies[no_of_timers];
+    uint8_t i;
+
+    tick(3);
+    for (i = 0; i < no_of_timers; i++)
+    {
+        spies[i].no_of_expiries = 0;
+        spies[i].target = NULL;
+        swtimer_setup(&timers[i], spy_callback, &spies[i]);
+        swtimer_start(&timers[i], delays[i], 0);
+    }
+
+    tick(1048580);
+
+    for (i = 0; i < no_of_timers; i++)
+    {
+        LONGS_EQUAL(1, spies[i].no_of_expiries);
+        LONGS_EQUAL(delays[i] + 3, spies[i].expired_at);
+    }
+}
+
+TEST(swtimer, long_periodic_timer)
+{
+    swtimer_start(&timer, 1000, 70000);
+    tick(1000 + 3 * 70000);
+    LONGS_EQUAL(4, spy.no_of_expiries);
+    LONGS_EQUAL(1000 + 3 * 70000, spy.expired_at);
+}
+
+TEST(swtimer, many_timers_expire_same_tick)
+{
+    static swtimer_t timers[1000];
+    uint16_t i;
+
+    for (i = 0; i < 1000; i++)
+    {
+        swtimer_setup(&timers[i], spy_callback, &spy);
+        swtimer_start(&timers[i], 300, 0);
+    }
+    tick(299);
+    LONGS_EQUAL(0, spy.no_of_expiries);
+    tick(1);
+    LONGS_EQUAL(1000, spy.no_of_expiries);
+}
+
+TEST(swtimer, callback_cancels_timer_expiring_same_tick)
+{
+    swtimer_t other;
+    TimerSpy_t other_spy = {0, 0, &timer};
+
+    // Whichever timer expires first cancels the other
+    spy.target = &other;
+    swtimer_setup(&timer, cancel_callback, &spy);
+    swtimer_setup(&other, cancel_callback, &other_spy);
+    swtimer_start(&timer, 20, 0);
+    swtimer_start(&other, 20, 0);
+    tick(20);
+    LONGS_EQUAL(1, other_spy.no_of_expiries + spy.no_of_expiries);
+}
+
+TEST(swtimer, callback_restarts_own_timer)
+{
+    swtimer_setup(&timer, restart_callback, &spy);
+    swtimer_start(&timer, 16, 0);
+    tick(100);
+    LONGS_EQUAL(3, spy.no_of_expiries);
+    LONGS_EQUAL(48, spy.expired_at);
+}
+
+
+/********************************************************************
+ * TEST RUNNER
+ ********************************************************************/
+int main(int ac, char** av)
+{
+    return CommandLineTestRunner::RunAllTests(ac, av);
+}
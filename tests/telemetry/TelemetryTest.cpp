@@ -0,0 +1,335 @@
+/*
+ * Unit tests for the Bit Loom telemetry.
+ *
+ * Copyright (c) 2021. BlueZephyr
+ *
+ * This software may be modified and distributed under the terms
+ * of the MIT license.  See the LICENSE file for details.
+ *
+ */
+
+#include "CppUTest/CommandLineTestRunner.h"
+#include "CppUTestExt/MockSupport.h"
+
+extern "C"
+{
+    #include "core/telemetry.h"
+    #include "core/scheduler.h"
+    #include "mocks/uart_mock.h"
+    #include "mocks/spy_task.h"
+    #include "hal/timer.h"
+    #include "mocks/timer_mock.h"
+}
+
+static uint32_t metric_values[TELEMETRY_NO_METRICS];
+
+// 6 bytes of header and CRC and 5 bytes per metric
+#define MAX_FRAME_SIZE  (6 + 5 * TELEMETRY_NO_METRICS)
+
+static uint32_t read_metric (uint8_t index)
+{
+    return metric_values[index];
+}
+
+static void overrun_function (void)
+{
+    timer_mock_advance_ticks(1);
+}
+
+static uint8_t crc8 (const uint8_t *data, uint16_t length)
+{
+    uint8_t crc = 0;
+    uint8_t bit;
+
+    while (length--)
+    {
+        crc ^= *data++;
+        for (bit = 0; bit < 8; bit++)
+        {
+            crc = (crc & 0x80) ? (uint8_t)((crc << 1) ^ 0x07) : (uint8_t)(crc << 1);
+        }
+    }
+    return crc;
+}
+
+TEST_GROUP(telemetry)
+{
+    uint16_t decoded;
+
+    void setup() override
+    {
+        uint8_t i;
+
+        uart_mock_init();
+        telemetry_init();
+        decoded = 0;
+        for (i = 0; i < TELEMETRY_NO_METRICS; i++)
+        {
+            metric_values[i] = 0;
+        }
+    }
+
+    void teardown() override
+    {
+        mock().checkExpectations();
+        mock().clear();
+    }
+
+    uint16_t runs_to_send(uint16_t bytes)
+    {
+        return (bytes + TELEMETRY_BYTES_PER_RUN - 1) / TELEMETRY_BYTES_PER_RUN;
+    }
+
+    void run(uint16_t no_of_runs)
+    {
+        uint16_t i;
+
+        for (i = 0; i < no_of_runs; i++)
+        {
+            telemetry_run();
+        }
+    }
+
+    /*
+     * Decode the next frame in the captured bytes.  The values are the
+     * absolute values for keyframes and the differences for other frames.
+     */
+    uint8_t decode_frame(uint8_t *flags, uint32_t *values)
+    {
+        const uint8_t *frame = uart_mock_get_written() + decoded;
+        uint8_t length;
+        uint8_t position = 0;
+        uint8_t no_of_values = 0;
+        uint32_t value;
+        uint8_t shift;
+
+        CHECK(uart_mock_get_no_of_written() - decoded >= 6);
+        BYTES_EQUAL(TELEMETRY_SYNC, frame[0]);
+        BYTES_EQUAL(TELEMETRY_VERSION, frame[1]);
+        *flags = frame[2];
+        length = frame[4];
+        CHECK(uart_mock_get_no_of_written() - decoded >= length + 6);
+        BYTES_EQUAL(crc8(&frame[1], length + 4), frame[5 + length]);
+
+        while (position < length)
+        {
+            value = 0;
+            shift = 0;
+            do
+            {
+                value |= (uint32_t)(frame[5 + position] & 0x7F) << shift;
+                shift += 7;
+            } while (frame[5 + position++] & 0x80);
+            values[no_of_values++] = (value & 1) ? ~(value >> 1) : (value >> 1);
+        }
+
+        decoded += length + 6;
+        return no_of_values;
+    }
+};
+
+
+/*
+ * TEST CASES
+ */
+TEST(telemetry, first_run_sends_empty_keyframe)
+{
+    const uint8_t expected[] = {TELEMETRY_SYNC, TELEMETRY_VERSION, TELEMETRY_FLAG_KEYFRAME, 0, 0, 0};
+    uint8_t crc = crc8(&expected[1], 4);
+
+    run(1);
+    LONGS_EQUAL(TELEMETRY_UART_PORT, uart_mock_get_port());
+    LONGS_EQUAL(6, uart_mock_get_no_of_written());
+    MEMCMP_EQUAL(expected, uart_mock_get_written(), 5);
+    BYTES_EQUAL(crc, uart_mock_get_written()[5]);
+}
+
+TEST(telemetry, add_too_many_metrics)
+{
+    uint8_t i;
+
+    for (i = 0; i < TELEMETRY_NO_METRICS; i++)
+    {
+        LONGS_EQUAL(i, telemetry_add_metric(read_metric, i));
+    }
+    LONGS_EQUAL(TELEMETRY_INVALID_METRIC, telemetry_add_metric(read_metric, 0));
+}
+
+TEST(telemetry, keyframe_holds_values_as_varints)
+{
+    const uint8_t expected_payload[] = {0x00, 0xD8, 0x04};
+    uint8_t flags;
+    uint32_t values[3];
+
+    metric_values[1] = 300;
+    telemetry_add_metric(read_metric, 0);
+    telemetry_add_metric(read_metric, 1);
+    run(2);
+
+    MEMCMP_EQUAL(expected_payload, uart_mock_get_written() + 5, 3);
+    LONGS_EQUAL(2, decode_frame(&flags, values));
+    BYTES_EQUAL(TELEMETRY_FLAG_KEYFRAME, flags);
+    UNSIGNED_LONGS_EQUAL(0, values[0]);
+    UNSIGNED_LONGS_EQUAL(300, values[1]);
+}
+
+TEST(telemetry, snapshot_every_period)
+{
+    uint8_t flags;
+    uint32_t values[1];
+
+    telemetry_add_metric(read_metric, 0);
+    run(TELEMETRY_PERIOD);
+    decode_frame(&flags, values);
+    LONGS_EQUAL(decoded, uart_mock_get_no_of_written());
+    run(1);
+    decode_frame(&flags, values);
+}
+
+TEST(telemetry, frames_hold_differences)
+{
+    uint8_t flags;
+    uint32_t values[2];
+
+    telemetry_add_metric(read_metric, 0);
+    telemetry_add_metric(read_metric, 1);
+    metric_values[0] = 1000;
+    metric_values[1] = 0xFFFFFFF0;
+    run(1);
+    metric_values[0] = 1005;
+    metric_values[1] = 0x00000010;
+    run(TELEMETRY_PERIOD);
+    metric_values[0] = 995;
+    run(TELEMETRY_PERIOD);
+
+    decode_frame(&flags, values);
+    LONGS_EQUAL(2, decode_frame(&flags, values));
+    BYTES_EQUAL(0, flags);
+    UNSIGNED_LONGS_EQUAL(5, values[0]);
+    UNSIGNED_LONGS_EQUAL(0x20, values[1]);
+    decode_frame(&flags, values);
+    LONGS_EQUAL(-10, (int32_t)values[0]);
+    UNSIGNED_LONGS_EQUAL(0, values[1]);
+}
+
+TEST(telemetry, keyframe_interval)
+{
+    uint8_t flags;
+    uint32_t values[1];
+    uint8_t i;
+
+    telemetry_add_metric(read_metric, 0);
+    run(1 + TELEMETRY_KEYFRAME_INTERVAL * TELEMETRY_PERIOD);
+
+    for (i = 0; i <= TELEMETRY_KEYFRAME_INTERVAL; i++)
+    {
+        decode_frame(&flags, values);
+        BYTES_EQUAL((i % TELEMETRY_KEYFRAME_INTERVAL) == 0 ? TELEMETRY_FLAG_KEYFRAME : 0, flags);
+    }
+}
+
+TEST(telemetry, requested_keyframe)
+{
+    uint8_t flags;
+    uint32_t values[1];
+
+    telemetry_add_metric(read_metric, 0);
+    run(1);
+    telemetry_request_keyframe();
+    run(TELEMETRY_PERIOD);
+    decode_frame(&flags, values);
+    decode_frame(&flags, values);
+    BYTES_EQUAL(TELEMETRY_FLAG_KEYFRAME, flags);
+}
+
+TEST(telemetry, frame_is_sent_in_chunks)
+{
+    uint8_t flags;
+    uint32_t values[TELEMETRY_NO_METRICS];
+    uint8_t i;
+
+    for (i = 0; i < TELEMETRY_NO_METRICS; i++)
+    {
+        metric_values[i] = 0x10000000;
+        telemetry_add_metric(read_metric, i);
+    }
+
+    run(1);
+    LONGS_EQUAL(TELEMETRY_BYTES_PER_RUN, uart_mock_get_no_of_written());
+    run(runs_to_send(MAX_FRAME_SIZE) - 1);
+    LONGS_EQUAL(MAX_FRAME_SIZE, uart_mock_get_no_of_written());
+    LONGS_EQUAL(TELEMETRY_NO_METRICS, decode_frame(&flags, values));
+    UNSIGNED_LONGS_EQUAL(0x10000000, values[TELEMETRY_NO_METRICS - 1]);
+}
+
+/*
+ * All varints are 5 bytes, i.e., the keyframe has the maximum size.
+ */
+TEST(telemetry, keyframe_with_max_metrics_and_large_values)
+{
+    uint8_t flags;
+    uint32_t values[TELEMETRY_NO_METRICS];
+    uint8_t i;
+
+    for (i = 0; i < TELEMETRY_NO_METRICS; i++)
+    {
+        metric_values[i] = 0x80000000;
+        telemetry_add_metric(read_metric, i);
+    }
+
+    run(runs_to_send(MAX_FRAME_SIZE));
+    LONGS_EQUAL(MAX_FRAME_SIZE, uart_mock_get_no_of_written());
+    LONGS_EQUAL(TELEMETRY_NO_METRICS, decode_frame(&flags, values));
+    BYTES_EQUAL(TELEMETRY_FLAG_KEYFRAME, flags);
+    for (i = 0; i < TELEMETRY_NO_METRICS; i++)
+    {
+        UNSIGNED_LONGS_EQUAL(0x80000000, values[i]);
+    }
+}
+
+TEST(telemetry, full_uart_buffer_delays_frame)
+{
+    uint8_t flags;
+    uint32_t values[1];
+
+    telemetry_add_metric(read_metric, 0);
+    uart_mock_set_space(0);
+    run(TELEMETRY_PERIOD);
+    LONGS_EQUAL(0, uart_mock_get_no_of_written());
+
+    // The snapshot is skipped since the previous frame has not been sent
+    metric_values[0] = 7;
+    uart_mock_set_space(1000);
+    run(1);
+    LONGS_EQUAL(7, uart_mock_get_no_of_written());
+    decode_frame(&flags, values);
+    UNSIGNED_LONGS_EQUAL(0, values[0]);
+}
+
+TEST(telemetry, scheduler_metrics)
+{
+    mock().ignoreOtherCalls();
+    timer_init();
+    schedule_init();
+    SpyTask_t task = spytask_create_counter_task(1, 0);
+    SpyTask_t overrun = spytask_create_overrun_task(2, 0, overrun_function);
+    uint8_t taskid = schedule_add_task(task.period, task.offset, task.run);
+    uint8_t overrun_taskid = schedule_add_task(overrun.period, overrun.offset, overrun.run);
+
+    schedule_start();
+    schedule_run();
+    UNSIGNED_LONGS_EQUAL(0, telemetry_metric_overrun_tasks(0));
+    schedule_run();
+    UNSIGNED_LONGS_EQUAL(2, telemetry_metric_task_runs(taskid));
+    UNSIGNED_LONGS_EQUAL((1UL << taskid) | (1UL << overrun_taskid),
+                         telemetry_metric_overrun_tasks(0));
+}
+
+
+/********************************************************************
+ * TEST RUNNER
+ ********************************************************************/
+int main(int ac, char** av)
+{
+    return CommandLineTestRunner::RunAllTests(ac, av);
+}
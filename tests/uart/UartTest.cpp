@@ -0,0 +1,302 @@
+/*
+ * Unit tests for the Bit Loom UART driver.
+ *
+ * The test config has the ports:
+ *  * UART_PORT1 - 16 bytes in, 32 bytes out, no flow control
+ *  * UART_PORT2 - 8 bytes in and out, RTS/CTS on pin 1 and 2
+ *  * UART_PORT3 - 8 bytes in and out, XON/XOFF
+ *
+ * Copyright (c) 2021. BlueZephyr
+ *
+ * This software may be modified and distributed under the terms
+ * of the MIT license.  See the LICENSE file for details.
+ *
+ */
+
+#include "CppUTest/CommandLineTestRunner.h"
+
+extern "C"
+{
+    #include "core/uart.h"
+    #include "mocks/uart_hal_mock.h"
+}
+
+#define RTS_PIN     1
+#define CTS_PIN     2
+
+TEST_GROUP(uart)
+{
+    uart_stats_t stats;
+    uint8_t data[64];
+
+    void setup() override
+    {
+        uint8_t i;
+
+        uart_hal_mock_init();
+        for (i = 0; i < UART_NO_PORTS; i++)
+        {
+            uart_init((enum uart_port_t)i);
+        }
+        for (i = 0; i < sizeof(data); i++)
+        {
+            data[i] = i;
+        }
+    }
+
+    void receive(enum uart_port_t port, uint32_t nbytes)
+    {
+        uint32_t i;
+
+        for (i = 0; i < nbytes; i++)
+        {
+            uart_receive_byte(port, (uint8_t)i);
+        }
+    }
+};
+
+
+/*
+ * TEST CASES
+ */
+TEST(uart, stats_after_init)
+{
+    uart_get_stats(UART_PORT1, &stats);
+    LONGS_EQUAL(0, stats.rx_bytes);
+    LONGS_EQUAL(0, stats.tx_bytes);
+    LONGS_EQUAL(0, stats.rx_dropped);
+    LONGS_EQUAL(0, stats.tx_rejected);
+    LONGS_EQUAL(0, stats.rx_high_water);
+    LONGS_EQUAL(0, stats.tx_high_water);
+}
+
+TEST(uart, received_bytes_are_read)
+{
+    uint8_t buffer[4];
+
+    uart_receive_byte(UART_PORT1, 0x55);
+    uart_receive_byte(UART_PORT1, 0xAA);
+    LONGS_EQUAL(2, uart_read(UART_PORT1, buffer, sizeof(buffer)));
+    BYTES_EQUAL(0x55, buffer[0]);
+    BYTES_EQUAL(0xAA, buffer[1]);
+    LONGS_EQUAL(0, uart_read(UART_PORT1, buffer, sizeof(buffer)));
+}
+
+TEST(uart, ports_are_independent)
+{
+    uint8_t buffer[4];
+
+    uart_receive_byte(UART_PORT0, 1);
+    LONGS_EQUAL(0, uart_read(UART_PORT1, buffer, sizeof(buffer)));
+    LONGS_EQUAL(1, uart_read(UART_PORT0, buffer, sizeof(buffer)));
+}
+
+TEST(uart, byte_is_dropped_when_in_buffer_is_full)
+{
+    receive(UART_PORT1, 20);
+    uart_get_stats(UART_PORT1, &stats);
+    LONGS_EQUAL(16, stats.rx_bytes);
+    LONGS_EQUAL(4, stats.rx_dropped);
+    LONGS_EQUAL(16, stats.rx_high_water);
+}
+
+TEST(uart, rx_dropped_saturates)
+{
+    receive(UART_PORT1, 16 + UINT16_MAX + 10);
+    uart_get_stats(UART_PORT1, &stats);
+    LONGS_EQUAL(UINT16_MAX, stats.rx_dropped);
+}
+
+TEST(uart, rx_high_water_is_highest_fill_level)
+{
+    uint8_t buffer[16];
+
+    receive(UART_PORT1, 10);
+    uart_read(UART_PORT1, buffer, sizeof(buffer));
+    receive(UART_PORT1, 4);
+    uart_get_stats(UART_PORT1, &stats);
+    LONGS_EQUAL(14, stats.rx_bytes);
+    LONGS_EQUAL(10, stats.rx_high_water);
+}
+
+TEST(uart, write_is_limited_by_out_buffer)
+{
+    LONGS_EQUAL(32, uart_write(UART_PORT1, data, 40));
+    LONGS_EQUAL(1, uart_hal_mock_get_sends(UART_PORT1));
+    uart_get_stats(UART_PORT1, &stats);
+    LONGS_EQUAL(32, stats.tx_bytes);
+    LONGS_EQUAL(8, stats.tx_rejected);
+    LONGS_EQUAL(32, stats.tx_high_water);
+}
+
+TEST(uart, tx_high_water_is_highest_fill_level)
+{
+    uart_write(UART_PORT1, data, 20);
+    LONGS_EQUAL(20, uart_hal_mock_transmit(UART_PORT1, 20));
+    uart_write(UART_PORT1, data, 5);
+    uart_get_stats(UART_PORT1, &stats);
+    LONGS_EQUAL(25, stats.tx_bytes);
+    LONGS_EQUAL(20, stats.tx_high_water);
+}
+
+TEST(uart, tx_rejected_saturates)
+{
+    uint16_t i;
+
+    uart_write(UART_PORT1, data, 32);
+    for (i = 0; i < UINT16_MAX / 64 + 1; i++)
+    {
+        uart_write(UART_PORT1, data, 64);
+    }
+    uart_get_stats(UART_PORT1, &stats);
+    LONGS_EQUAL(UINT16_MAX, stats.tx_rejected);
+}
+
+TEST(uart, reset_stats_keeps_fill_levels_as_high_water)
+{
+    uint8_t buffer[8];
+
+    receive(UART_PORT1, 20);
+    uart_write(UART_PORT1, data, 40);
+    uart_read(UART_PORT1, buffer, sizeof(buffer));
+    uart_hal_mock_transmit(UART_PORT1, 12);
+    uart_reset_stats(UART_PORT1);
+    uart_get_stats(UART_PORT1, &stats);
+    LONGS_EQUAL(0, stats.rx_bytes);
+    LONGS_EQUAL(0, stats.tx_bytes);
+    LONGS_EQUAL(0, stats.rx_dropped);
+    LONGS_EQUAL(0, stats.tx_rejected);
+    LONGS_EQUAL(8, stats.rx_high_water);
+    LONGS_EQUAL(20, stats.tx_high_water);
+}
+
+TEST(uart, port_without_flow_control_stores_xoff)
+{
+    uint8_t buffer[1];
+
+    uart_receive_byte(UART_PORT1, UART_XOFF);
+    CHECK_TRUE(uart_transmit_allowed(UART_PORT1));
+    LONGS_EQUAL(1, uart_read(UART_PORT1, buffer, sizeof(buffer)));
+    BYTES_EQUAL(UART_XOFF, buffer[0]);
+}
+
+/*
+ * 8 byte in buffer, i.e., stop level 6 and resume level 2
+ */
+TEST(uart, rts_is_raised_at_stop_level_and_lowered_at_resume_level)
+{
+    uint8_t buffer[8];
+
+    CHECK_FALSE(pin_digital_io_mock_get(RTS_PIN));
+    receive(UART_PORT2, 5);
+    CHECK_FALSE(pin_digital_io_mock_get(RTS_PIN));
+    receive(UART_PORT2, 1);
+    CHECK_TRUE(pin_digital_io_mock_get(RTS_PIN));
+
+    uart_read(UART_PORT2, buffer, 3);
+    CHECK_TRUE(pin_digital_io_mock_get(RTS_PIN));
+    uart_read(UART_PORT2, buffer, 1);
+    CHECK_FALSE(pin_digital_io_mock_get(RTS_PIN));
+}
+
+TEST(uart, cts_high_pauses_transmission)
+{
+    CHECK_TRUE(uart_transmit_allowed(UART_PORT2));
+    pin_digital_io_mock_set(CTS_PIN, true);
+    CHECK_FALSE(uart_transmit_allowed(UART_PORT2));
+    uart_write(UART_PORT2, data, 4);
+    LONGS_EQUAL(0, uart_hal_mock_transmit(UART_PORT2, 4));
+    pin_digital_io_mock_set(CTS_PIN, false);
+    LONGS_EQUAL(4, uart_hal_mock_transmit(UART_PORT2, 4));
+}
+
+TEST(uart, xoff_is_sent_at_stop_level_and_xon_at_resume_level)
+{
+    uint8_t buffer[8];
+
+    // XON is sent at init
+    LONGS_EQUAL(1, uart_hal_mock_get_no_of_immediate(UART_PORT3));
+    receive(UART_PORT3, 6);
+    LONGS_EQUAL(2, uart_hal_mock_get_no_of_immediate(UART_PORT3));
+    BYTES_EQUAL(UART_XOFF, uart_hal_mock_get_last_immediate(UART_PORT3));
+
+    // Bytes received after XOFF are stored and XOFF is not sent again
+    receive(UART_PORT3, 1);
+    LONGS_EQUAL(2, uart_hal_mock_get_no_of_immediate(UART_PORT3));
+
+    uart_read(UART_PORT3, buffer, 4);
+    LONGS_EQUAL(2, uart_hal_mock_get_no_of_immediate(UART_PORT3));
+    uart_read(UART_PORT3, buffer, 1);
+    LONGS_EQUAL(3, uart_hal_mock_get_no_of_immediate(UART_PORT3));
+    BYTES_EQUAL(UART_XON, uart_hal_mock_get_last_immediate(UART_PORT3));
+}
+
+TEST(uart, received_xoff_and_xon_pause_and_resume_transmission)
+{
+    uint8_t buffer[1];
+
+    uart_write(UART_PORT3, data, 4);
+    uart_receive_byte(UART_PORT3, UART_XOFF);
+    CHECK_FALSE(uart_transmit_allowed(UART_PORT3));
+    LONGS_EQUAL(0, uart_hal_mock_transmit(UART_PORT3, 4));
+
+    uart_receive_byte(UART_PORT3, UART_XON);
+    CHECK_TRUE(uart_transmit_allowed(UART_PORT3));
+    LONGS_EQUAL(2, uart_hal_mock_get_sends(UART_PORT3));
+    LONGS_EQUAL(4, uart_hal_mock_transmit(UART_PORT3, 4));
+
+    // XON and XOFF are not stored
+    LONGS_EQUAL(0, uart_read(UART_PORT3, buffer, sizeof(buffer)));
+    uart_get_stats(UART_PORT3, &stats);
+    LONGS_EQUAL(0, stats.rx_bytes);
+}
+
+TEST(uart, per_port_functions_use_the_state_of_the_port)
+{
+    uint8_t buffer[4];
+
+    UART_RECEIVE_BYTE(UART_PORT1, 0x55);
+    LONGS_EQUAL(0, uart_read(UART_PORT0, buffer, sizeof(buffer)));
+    LONGS_EQUAL(1, uart_read(UART_PORT1, buffer, sizeof(buffer)));
+    BYTES_EQUAL(0x55, buffer[0]);
+
+    LONGS_EQUAL(32, UART_WRITE(UART_PORT1, data, 40));
+    uart_get_stats(UART_PORT1, &stats);
+    LONGS_EQUAL(32, stats.tx_bytes);
+    LONGS_EQUAL(8, stats.tx_rejected);
+    LONGS_EQUAL(1, uart_hal_mock_get_sends(UART_PORT1));
+}
+
+TEST(uart, per_port_functions_handle_flow_control)
+{
+    uint8_t i;
+
+    for (i = 0; i < 6; i++)
+    {
+        UART_RECEIVE_BYTE(UART_PORT2, i);
+    }
+    CHECK_TRUE(pin_digital_io_mock_get(RTS_PIN));
+    pin_digital_io_mock_set(CTS_PIN, true);
+    CHECK_FALSE(UART_TRANSMIT_ALLOWED(UART_PORT2));
+
+    UART_RECEIVE_BYTE(UART_PORT3, UART_XOFF);
+    CHECK_FALSE(UART_TRANSMIT_ALLOWED(UART_PORT3));
+    UART_RECEIVE_BYTE(UART_PORT3, UART_XON);
+    CHECK_TRUE(UART_TRANSMIT_ALLOWED(UART_PORT3));
+}
+
+#define FLOW_CONTROL_PORT   UART_PORT3
+TEST(uart, per_port_function_of_port_given_by_macro)
+{
+    UART_RECEIVE_BYTE(FLOW_CONTROL_PORT, UART_XOFF);
+    CHECK_FALSE(uart_transmit_allowed(UART_PORT3));
+}
+
+
+/********************************************************************
+ * TEST RUNNER
+ ********************************************************************/
+int main(int ac, char** av)
+{
+    return CommandLineTestRunner::RunAllTests(ac, av);
+}
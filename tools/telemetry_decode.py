@@ -0,0 +1,132 @@
+#!/usr/bin/env python3
+"""
+Decoder for the BitLoom binary telemetry frames (see include/core/telemetry.h).
+
+Reads the byte stream from a file, a serial device or stdin and prints one line
+per frame with the absolute values of the metrics.  Frames with a bad CRC are
+dropped and the decoder waits for a keyframe before printing any values and
+after a lost frame.
+
+Usage:
+    telemetry_decode.py [-n name1,name2,...] [input]
+
+Copyright (c) 2021 BlueZephyr
+
+This software may be modified and distributed under the terms
+of the MIT license.  See the LICENSE file for details.
+"""
+
+import argparse
+import sys
+
+SYNC = 0xB1
+VERSION = 1
+FLAG_KEYFRAME = 0x01
+HEADER_SIZE = 5
+
+
+def crc8(data):
+    crc = 0
+    for byte in data:
+        crc ^= byte
+        for _ in range(8):
+            crc = ((crc << 1) ^ 0x07) & 0xFF if crc & 0x80 else (crc << 1) & 0xFF
+    return crc
+
+
+def decode_varints(payload):
+    values = []
+    value = 0
+    shift = 0
+    for byte in payload:
+        value |= (byte & 0x7F) << shift
+        shift += 7
+        if not byte & 0x80:
+            values.append(((value >> 1) ^ -(value & 1)) & 0xFFFFFFFF)
+            value = 0
+            shift = 0
+    if shift != 0:
+        raise ValueError("truncated varint")
+    return values
+
+
+class Decoder:
+    def __init__(self):
+        self.buffer = bytearray()
+        self.values = None
+        self.sequence = None
+
+    def feed(self, data):
+        """Add received bytes and return a list of (sequence, values) tuples."""
+        self.buffer.extend(data)
+        frames = []
+        while True:
+            start = self.buffer.find(bytes([SYNC]))
+            if start < 0:
+                self.buffer.clear()
+                break
+            del self.buffer[:start]
+            if len(self.buffer) < HEADER_SIZE:
+                break
+            length = self.buffer[4]
+            if len(self.buffer) < HEADER_SIZE + length + 1:
+                break
+            frame = bytes(self.buffer[:HEADER_SIZE + length + 1])
+            if frame[1] != VERSION or crc8(frame[1:-1]) != frame[-1]:
+                # Not a frame start (or a corrupt frame), resynchronize
+                del self.buffer[:1]
+                continue
+            del self.buffer[:len(frame)]
+            frame = self.decode(frame)
+            if frame is not None:
+                frames.append(frame)
+        return frames
+
+    def decode(self, frame):
+        flags = frame[2]
+        sequence = frame[3]
+        try:
+            values = decode_varints(frame[HEADER_SIZE:-1])
+        except ValueError:
+            self.values = None
+            return None
+
+        if flags & FLAG_KEYFRAME:
+            self.values = values
+        elif (self.values is None or len(values) != len(self.values) or
+              sequence != (self.sequence + 1) & 0xFF):
+            # A frame has been lost, wait for the next keyframe
+            self.values = None
+        else:
+            self.values = [(v + d) & 0xFFFFFFFF for v, d in zip(self.values, values)]
+
+        self.sequence = sequence
+        if self.values is None:
+            return None
+        return sequence, list(self.values)
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__.split("\n\n")[0])
+    parser.add_argument("-n", "--names", help="comma separated metric names")
+    parser.add_argument("input", nargs="?", help="input file or serial device (default stdin)")
+    args = parser.parse_args()
+
+    names = args.names.split(",") if args.names else None
+    stream = open(args.input, "rb", buffering=0) if args.input else sys.stdin.buffer
+    decoder = Decoder()
+
+    while True:
+        data = stream.read(256)
+        if not data:
+            break
+        for sequence, values in decoder.feed(data):
+            if names:
+                fields = ["%s=%d" % (n, v) for n, v in zip(names, values)]
+            else:
+                fields = [str(v) for v in values]
+            print("%3d: %s" % (sequence, " ".join(fields)), flush=True)
+
+
+if __name__ == "__main__":
+    main()